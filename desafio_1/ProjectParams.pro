@@ -1,17 +1,11 @@
 QT += core gui
 CONFIG += console c++17
 
-SOURCES += \
-    src/bitwise_pixel.cpp \
-    src/main.cpp \
-    src/process_data.cpp
-
-HEADERS += \
-    include/bitwise_pixel.hpp \
-    include/constants.hpp \
-    include/process_data.hpp
+include(core.pri)
 
-INCLUDEPATH += include
+# Carga y exportación de imágenes con QImage
+SOURCES += \
+    src/image_io_qt.cpp
 
 DESTDIR = bin
 OBJECTS_DIR = build
@@ -0,0 +1,16 @@
+# Binario headless sin Qt: enlazado estático para minimizar el arranque en trabajos por lotes
+CONFIG -= qt
+CONFIG += console c++17
+
+include(core.pri)
+
+# Carga y exportación de imágenes con bmp_io: lee BMP sin compresión de 1, 4, 8, 16, 24 o 32 bits
+# (no RLE, a diferencia de Qt) y escribe BMP de 24 bits
+SOURCES += \
+    src/image_io_bmp.cpp
+
+QMAKE_LFLAGS += -static
+
+DESTDIR = bin
+OBJECTS_DIR = build_core
+TARGET = reto_1_core
@@ -0,0 +1,34 @@
+# Núcleo sin Qt, compartido por el front end con Qt (ProjectParams.pro) y el binario headless (ProjectParamsCore.pro)
+CONFIG += c++17
+
+SOURCES += \
+    $$PWD/src/bit_planes.cpp \
+    $$PWD/src/bitwise_pixel.cpp \
+    $$PWD/src/bmp_io.cpp \
+    $$PWD/src/checkpoint.cpp \
+    $$PWD/src/frames.cpp \
+    $$PWD/src/img_alloc.cpp \
+    $$PWD/src/main.cpp \
+    $$PWD/src/mask_io.cpp \
+    $$PWD/src/noise_source.cpp \
+    $$PWD/src/perf_counters.cpp \
+    $$PWD/src/process_data.cpp \
+    $$PWD/src/verify.cpp
+
+HEADERS += \
+    $$PWD/include/bit_planes.hpp \
+    $$PWD/include/bitwise_pixel.hpp \
+    $$PWD/include/bmp_io.hpp \
+    $$PWD/include/checkpoint.hpp \
+    $$PWD/include/constants.hpp \
+    $$PWD/include/frames.hpp \
+    $$PWD/include/image_io.hpp \
+    $$PWD/include/img_alloc.hpp \
+    $$PWD/include/mask_io.hpp \
+    $$PWD/include/noise_source.hpp \
+    $$PWD/include/perf_counters.hpp \
+    $$PWD/include/process_data.hpp \
+    $$PWD/include/verify.hpp
+
+INCLUDEPATH += $$PWD $$PWD/include
+LIBS += -pthread
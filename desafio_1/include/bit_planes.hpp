@@ -0,0 +1,40 @@
+#ifndef BIT_PLANES_HPP
+#define BIT_PLANES_HPP
+    #include <stdint.h>
+    #include "include/constants.hpp"
+
+    /// Imagen almacenada como BITS_ON_BYTE planos de bits: el bit j de la palabra j/64 del plano k es el bit k del byte j
+    struct bit_planes {
+        uint64_t *data;                 ///< BITS_ON_BYTE planos físicos consecutivos de `n_words` palabras
+        uint32_t n_bytes;               ///< Número de bytes representados
+        uint32_t n_words;               ///< Palabras de 64 bits por plano
+        uint8_t map[BITS_ON_BYTE];      ///< Plano físico que contiene el plano lógico k
+        bool zero[BITS_ON_BYTE];        ///< El plano lógico k vale cero y su plano físico no se ha materializado
+    };
+
+    bool bit_planes_init(bit_planes &bp, const uint32_t n_bytes);
+
+    void bit_planes_free(bit_planes &bp);
+
+    void bit_planes_from_bytes(bit_planes &bp, const uint8_t *bytes);
+
+    void bit_planes_to_bytes(const bit_planes &bp, uint8_t *bytes);
+
+    void bit_planes_window(const bit_planes &bp, const uint32_t offset, bit_planes &window);
+
+    void bit_planes_rotate_left(bit_planes &bp, const uint8_t n);
+
+    void bit_planes_rotate_right(bit_planes &bp, const uint8_t n);
+
+    void bit_planes_shift_left(bit_planes &bp, const uint8_t n);
+
+    void bit_planes_shift_right(bit_planes &bp, const uint8_t n);
+
+    void bit_planes_xor(bit_planes &bp, const bit_planes &other);
+
+    uint32_t bit_planes_validate_xor(const bit_planes &img_window, const bit_planes &noisy_window, const bit_planes &reversed_mask);
+
+    uint32_t bit_planes_validate_rotate_shift(const uint8_t op_code, const bit_planes &img_window,
+                                              const bit_planes &reversed_mask, const uint8_t n);
+
+#endif // BIT_PLANES_HPP
@@ -3,6 +3,19 @@
     #include <stdint.h>
     #include "include/constants.hpp"
 
+    /// Operación detectada en una etapa de la cadena de transformaciones
+    struct stage_op {
+        uint8_t op_code;    ///< Código de la operación (XOR_OP, ROR_OP, ROL_OP, SHL_OP, SHR_OP)
+        uint8_t n;          ///< Número de bits de la rotación/desplazamiento (DUMMY_N para XOR)
+    };
+
+    /// Cadena de reversión compilada: resultado[i] = img_lut[img[i]] ^ noisy_lut[ruido[i]]
+    struct fused_chain {
+        uint8_t img_lut[BYTE_VALUES];       ///< Transformación lineal acumulada sobre la imagen
+        uint8_t noisy_lut[BYTE_VALUES];     ///< Aporte acumulado de la imagen de ruido por los pasos XOR
+        bool uses_noise;                    ///< La cadena contiene al menos un XOR
+    };
+
     uint32_t validate_xor(const uint8_t *img_data, const uint8_t *noisy_img_data,
                                 const uint8_t *reversed_mask, const uint32_t seed, const uint32_t mask_size);
 
@@ -26,6 +39,20 @@
 
     void apply_complete_xor(uint8_t *img_data, const uint8_t *img_noisy_data, const uint16_t width, const uint16_t height);
 
+    void fused_chain_init(fused_chain &fc);
+
+    void fused_chain_reverse(fused_chain &fc, const uint8_t op, const uint8_t n);
+
+    void fused_chain_forward(fused_chain &fc, const uint8_t op, const uint8_t n);
+
+    uint8_t fused_chain_kept_bits(const fused_chain &fc);
+
+    uint8_t fused_chain_output_bits(const fused_chain &fc);
+
+    bool fused_chain_equal(const fused_chain &a, const fused_chain &b);
+
+    void apply_fused_chain(const fused_chain &fc, uint8_t *img_data, const uint8_t *img_noisy_data, const uint32_t size);
+
     void pruebas_bitwise_byte_ops(void);
 
 #endif // BITWISE_PIXEL_HPP
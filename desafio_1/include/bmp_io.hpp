@@ -0,0 +1,31 @@
+#ifndef BMP_IO_HPP
+#define BMP_IO_HPP
+    #include <stdint.h>
+    #include <stddef.h>
+    #include "include/constants.hpp"
+
+    /// Archivo BMP sin compresión (1, 4, 8, 16, 24 o 32 bits) abierto para leer sus filas con pread
+    struct bmp_file {
+        int fd;                     ///< Descriptor del archivo (-1 si está cerrado)
+        uint8_t *header;            ///< Copia de las cabeceras y la paleta (bytes [0, data_offset) del archivo)
+        size_t file_size;           ///< Tamaño del archivo en bytes
+        uint32_t data_offset;       ///< Posición de la matriz de píxeles (filas con relleno a 4 bytes)
+        uint32_t stride;            ///< Bytes por fila, incluyendo el relleno
+        uint16_t width;             ///< Ancho en píxeles
+        uint16_t height;            ///< Alto en píxeles
+        bool top_down;              ///< true si la primera fila del archivo es la superior
+        uint16_t bits;              ///< Bits por píxel
+        const uint8_t *palette;     ///< Paleta B, G, R, 0 para 1, 4 y 8 bits, dentro de `header` (nullptr en los demás)
+        uint32_t palette_size;      ///< Número de colores de la paleta
+        uint32_t masks[RGB_CHANNELS];   ///< Máscaras de R, G y B para 16 y 32 bits
+    };
+
+    bool bmp_file_open(const char *path, bmp_file &bf);
+
+    void bmp_file_close(bmp_file &bf);
+
+    bool bmp_file_read_rgb(const bmp_file &bf, const uint32_t offset, const uint32_t size, uint8_t *out);
+
+    bool bmp_write(const char *path, const uint8_t *pixel_data, const uint16_t width, const uint16_t height);
+
+#endif // BMP_IO_HPP
@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+    #include <stdint.h>
+    #include <atomic>
+    #include <thread>
+    #include "include/bitwise_pixel.hpp"
+    #include "include/noise_source.hpp"
+
+    /// Huella de las entradas con las que se generó un checkpoint
+    struct checkpoint_inputs {
+        uint64_t noise_id;          ///< Semilla de Philox4x32-10, o FNV-1a de los píxeles de I_M.bmp
+        uint32_t target_hash;       ///< FNV-1a de los píxeles de I_D.bmp
+        uint32_t noise_generated;   ///< 1 si el ruido se generó con Philox4x32-10, 0 si se leyó de I_M.bmp
+    };
+
+    /// Cabecera del archivo de checkpoint, seguida por las operaciones y los bytes de la imagen
+    struct checkpoint_header {
+        uint32_t magic;         ///< Identificador del formato (CHECKPOINT_MAGIC)
+        uint16_t width;         ///< Ancho de la imagen en píxeles
+        uint16_t height;        ///< Alto de la imagen en píxeles
+        uint8_t n_total;        ///< Número total de etapas de la cadena
+        uint8_t next_stage;     ///< Etapa que falta por revertir (0 si ya terminó)
+        uint16_t reserved;
+        uint32_t checksum;      ///< FNV-1a de la cabecera (con este campo en cero), las operaciones y la imagen
+        checkpoint_inputs inputs;   ///< Entradas de la ejecución que guardó el checkpoint
+    };
+
+    /// Estado del escritor asíncrono de checkpoints
+    struct checkpoint_writer {
+        std::thread worker;             ///< Hilo que escribe el último snapshot en disco
+        std::atomic<bool> busy;         ///< true mientras el hilo no haya terminado de escribir
+        uint8_t *snapshot;              ///< Cabecera + operaciones + copia de la imagen
+        uint32_t snapshot_size;         ///< Tamaño total del snapshot en bytes
+    };
+
+    void checkpoint_fingerprint(checkpoint_inputs &inputs, const uint8_t *img_data, const uint32_t img_size,
+                                const noise_source &noise, const bool noise_generated);
+
+    bool checkpoint_init(checkpoint_writer &cw, const uint16_t width, const uint16_t height, const uint8_t n_total,
+                         const checkpoint_inputs &inputs);
+
+    bool checkpoint_save_async(checkpoint_writer &cw, const uint8_t *img_data, const stage_op *ops, const uint8_t next_stage);
+
+    void checkpoint_finish(checkpoint_writer &cw);
+
+    bool checkpoint_load(const char *path, uint8_t *img_data, stage_op *ops, const uint16_t width,
+                         const uint16_t height, const uint8_t n_total, const checkpoint_inputs &inputs,
+                         uint8_t &next_stage);
+
+#endif // CHECKPOINT_HPP
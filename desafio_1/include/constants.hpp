@@ -5,6 +5,7 @@
     #define GREEN_CHANNEL 1
     #define BLUE_CHANNEL 2
     #define BITS_ON_BYTE 8
+    #define BYTE_VALUES 256
     #define MAX_SIMILARITY 0
     #define XOR_OP 0
     #define ROR_OP 1
@@ -12,4 +13,12 @@
     #define SHL_OP 4
     #define SHR_OP 8
     #define DUMMY_N 0
+    #define CHECKPOINT_INTERVAL 8
+    #define CHECKPOINT_PATH "checkpoint.bin"
+    #define CHECKPOINT_TMP_PATH "checkpoint.tmp"
+    #define LOAD_CHUNK_ROWS 16
+    #define NOISE_CHUNK_SIZE (64*1024)
+    #define CHAIN_PATH "cadena.txt"
+    #define MASK_NAME_SIZE 32
+    #define MAX_BEAM_WIDTH 64
 #endif // CONSTANTS_HPP
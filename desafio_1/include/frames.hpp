@@ -0,0 +1,9 @@
+#ifndef FRAMES_HPP
+#define FRAMES_HPP
+    #include <stdint.h>
+    #include "include/bitwise_pixel.hpp"
+
+    bool process_frames(const stage_op *ops, const uint8_t n, const uint8_t *img_noisy_data,
+                            const uint16_t width, const uint16_t height, const uint32_t n_frames);
+
+#endif // FRAMES_HPP
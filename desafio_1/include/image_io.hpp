@@ -0,0 +1,13 @@
+#ifndef IMAGE_IO_HPP
+#define IMAGE_IO_HPP
+    #include <stdint.h>
+
+    /*
+     * Carga y exportación de imágenes RGB888. Hay dos implementaciones con la misma interfaz y se elige una al
+     * enlazar: image_io_qt.cpp (QImage, front end con Qt) e image_io_bmp.cpp (bmp_io, núcleo sin Qt).
+     */
+
+    unsigned char* loadPixels(const char *input, uint16_t &width, uint16_t &height);
+    bool exportImage(unsigned char* pixelData, uint16_t width, uint16_t height, const char *archivoSalida);
+
+#endif // IMAGE_IO_HPP
@@ -0,0 +1,13 @@
+#ifndef IMG_ALLOC_HPP
+#define IMG_ALLOC_HPP
+    #include <stddef.h>
+
+    void *img_alloc(const size_t size);
+
+    void img_free(void *ptr);
+
+    void img_alloc_set_huge_pages(const bool enabled);
+
+    bool img_alloc_interleave(void *ptr);
+
+#endif // IMG_ALLOC_HPP
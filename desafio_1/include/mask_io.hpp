@@ -0,0 +1,8 @@
+#ifndef MASK_IO_HPP
+#define MASK_IO_HPP
+    #include <stdint.h>
+
+    bool read_reversed_mask(const char *path, const uint8_t *mask_data, const uint32_t mask_size,
+                            const uint32_t img_size, uint32_t &seed, uint8_t *reversed_mask);
+
+#endif // MASK_IO_HPP
@@ -0,0 +1,40 @@
+#ifndef NOISE_SOURCE_HPP
+#define NOISE_SOURCE_HPP
+    #include <stdint.h>
+    #include "include/bmp_io.hpp"
+    #include "include/bitwise_pixel.hpp"
+
+    struct noise_source;
+
+    /// Escribe en `out` los bytes [offset, offset + size) de la imagen de ruido
+    typedef void (*noise_fill)(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out);
+
+    /// Origen de la imagen de ruido I_M: archivo cargado, archivo leído por rangos o generador con contador
+    struct noise_source {
+        noise_fill fill;            ///< Lectura de un rango arbitrario de bytes
+        const uint8_t *data;        ///< Imagen completa en memoria, o nullptr si solo se lee por rangos
+        uint8_t *owned;             ///< Buffer reservado por la fuente (liberar con `noise_source_close`)
+        bmp_file file;              ///< Archivo leído por rangos (solo para la fuente de archivo sin cargar)
+        uint64_t key;               ///< Semilla del generador (solo para la fuente generada)
+        uint16_t width;             ///< Ancho de la imagen de ruido en píxeles
+        uint16_t height;            ///< Alto de la imagen de ruido en píxeles
+    };
+
+    bool noise_source_load(noise_source &ns, const char *path);
+
+    bool noise_source_open(noise_source &ns, const char *path);
+
+    void noise_source_generate(noise_source &ns, const uint64_t key, const uint16_t width, const uint16_t height);
+
+    bool noise_source_materialize(noise_source &ns);
+
+    const uint8_t *noise_source_window(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *buffer);
+
+    void noise_source_apply_chain(const noise_source &ns, const fused_chain &fc, uint8_t *img_data, const uint32_t size,
+                                  uint8_t *chunk, const uint32_t chunk_size);
+
+    void noise_source_close(noise_source &ns);
+
+    void philox_fill(const uint64_t key, const uint64_t offset, const uint32_t size, uint8_t *out);
+
+#endif // NOISE_SOURCE_HPP
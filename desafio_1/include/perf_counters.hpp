@@ -0,0 +1,22 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+    #include <stdint.h>
+
+    #define PERF_EVENTS 4
+
+    /// Descriptores de los contadores de hardware abiertos con perf_event_open (-1 si no están disponibles)
+    struct perf_counters {
+        int fd[PERF_EVENTS];
+    };
+
+    bool perf_counters_start(perf_counters &pc);
+
+    void perf_counters_report(perf_counters &pc, const char *label);
+
+    void startup_mark_main(void);
+
+    double startup_main_ms(void);
+
+    double startup_premain_ms(double &resolution_ms);
+
+#endif // PERF_COUNTERS_HPP
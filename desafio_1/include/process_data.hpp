@@ -1,8 +1,19 @@
 #ifndef PROCESS_DATA_HPP
 #define PROCESS_DATA_HPP
     #include <stdint.h>
-    unsigned int* loadSeedMasking(const char* nombreArchivo, uint32_t &seed, uint32_t &n_pixels);
-    bool exportImage(unsigned char* pixelData, uint16_t width, uint16_t height, QString archivoSalida);
-    unsigned char* loadPixels(QString input, uint16_t &width, uint16_t &height);
-    void app_img(uint8_t n);
+
+    /// Opciones de ejecución de `app_img`
+    struct app_options {
+        bool resume;        ///< Reanudar desde el último checkpoint en lugar de la etapa n
+        bool bit_planes;    ///< Usar la representación en planos de bits para la imagen y el ruido
+        uint32_t frames;    ///< Número de cuadros I_D<k>.bmp a restaurar con la cadena detectada (0 = ninguno)
+        bool huge_pages;    ///< Reservar los buffers grandes con páginas grandes
+        bool perf;          ///< Medir fallos de TLB y accesos remotos durante la reversión
+        uint32_t low_mem_budget;    ///< Presupuesto de memoria en MiB para el modo de baja memoria (0 = desactivado)
+        uint32_t beam_width;        ///< Hipótesis por etapa de la búsqueda en haz (0 = selección voraz)
+        bool noise_generated;       ///< Generar el ruido con Philox4x32-10 en lugar de leer I_M.bmp
+        uint64_t noise_seed;        ///< Semilla del generador de ruido
+    };
+
+    bool app_img(uint8_t n, const app_options &opts);
 #endif // PROCESS_DATA_HPP
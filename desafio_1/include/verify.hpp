@@ -0,0 +1,23 @@
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+    #include <stdint.h>
+    #include "include/bitwise_pixel.hpp"
+
+    /// Diferencias entre dos imágenes del mismo tamaño
+    struct image_diff {
+        uint64_t bytes_diff;    ///< Bytes distintos
+        uint64_t hamming;       ///< Bits distintos (distancia de Hamming)
+        uint64_t sq_error;      ///< Suma de los cuadrados de las diferencias, para el PSNR
+    };
+
+    void diff_images(const uint8_t *img_a, const uint8_t *img_b, const uint32_t size, image_diff &diff);
+
+    double diff_psnr(const image_diff &diff, const uint32_t size);
+
+    bool chain_save(const char *path, const stage_op *ops, const uint8_t n);
+
+    stage_op *chain_load(const char *path, uint8_t &n);
+
+    bool verify_chain(const char *reference_path, const bool noise_generated, const uint64_t noise_seed);
+
+#endif // VERIFY_HPP
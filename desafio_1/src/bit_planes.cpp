@@ -0,0 +1,396 @@
+#include <stdint.h>
+#include <cstring>
+#include "include/bit_planes.hpp"
+#include "include/img_alloc.hpp"
+#include "include/constants.hpp"
+
+#define WORD_BITS 64
+
+static uint64_t transpose_8x8(uint64_t x);
+static const uint64_t *logical_plane(const bit_planes &bp, const uint8_t k);
+static uint32_t plane_distance(const uint64_t *plane_1, const uint64_t *plane_2, const uint32_t n_words);
+static void reset_map(bit_planes &bp);
+
+bool bit_planes_init(bit_planes &bp, const uint32_t n_bytes)
+{
+    /**
+     * @brief Reserva los planos de bits necesarios para representar `n_bytes` bytes.
+     *
+     * Los planos se inicializan en cero, con la correspondencia identidad entre planos lógicos y físicos.
+     *
+     * @param bp Estructura a inicializar.
+     * @param n_bytes Número de bytes (canales) a representar.
+     * @return true si se pudo reservar la memoria; false en caso contrario.
+     */
+    bp.n_bytes = n_bytes;
+    bp.n_words = (n_bytes + WORD_BITS - 1) / WORD_BITS;
+    bp.data = static_cast<uint64_t *>(img_alloc(BITS_ON_BYTE*bp.n_words*sizeof(uint64_t)));
+
+    if (bp.data == nullptr)
+        return false;
+
+    memset(bp.data, 0, BITS_ON_BYTE*bp.n_words*sizeof(uint64_t));
+
+    reset_map(bp);
+    return true;
+}
+
+void bit_planes_free(bit_planes &bp)
+{
+    /**
+     * @brief Libera la memoria de los planos de bits.
+     *
+     * @param bp Estructura a liberar.
+     */
+    img_free(bp.data);
+    bp.data = nullptr;
+}
+
+void bit_planes_from_bytes(bit_planes &bp, const uint8_t *bytes)
+{
+    /**
+     * @brief Transpone un arreglo de bytes (RGB888 plano) a planos de bits.
+     *
+     * Cada grupo de 8 bytes se trata como una matriz de 8x8 bits y se transpone en registro, de modo que
+     * el byte k del resultado contiene el bit k de los 8 bytes originales.
+     *
+     * @param bp Planos destino, inicializados con `bit_planes_init`.
+     * @param bytes Arreglo de `bp.n_bytes` bytes de origen.
+     */
+    reset_map(bp);
+
+    for (uint32_t w = 0; w < bp.n_words; w++) {
+        uint64_t planes[BITS_ON_BYTE] = {0};
+
+        for (uint8_t g = 0; g < BITS_ON_BYTE; g++) {
+            uint32_t base = w*WORD_BITS + g*BITS_ON_BYTE;
+            uint64_t x = 0;
+
+            for (uint8_t j = 0; j < BITS_ON_BYTE && (base + j) < bp.n_bytes; j++)
+                x |= (uint64_t)bytes[base + j] << (j*BITS_ON_BYTE);
+
+            x = transpose_8x8(x);
+
+            for (uint8_t k = 0; k < BITS_ON_BYTE; k++)
+                planes[k] |= ((x >> (k*BITS_ON_BYTE)) & 0xFF) << (g*BITS_ON_BYTE);
+        }
+
+        for (uint8_t k = 0; k < BITS_ON_BYTE; k++)
+            bp.data[k*bp.n_words + w] = planes[k];
+    }
+}
+
+void bit_planes_to_bytes(const bit_planes &bp, uint8_t *bytes)
+{
+    /**
+     * @brief Transpone los planos de bits de vuelta a un arreglo de bytes (RGB888 plano).
+     *
+     * Se respeta la correspondencia lógica de los planos, por lo que las rotaciones y desplazamientos
+     * pendientes quedan aplicados en el resultado.
+     *
+     * @param bp Planos de origen.
+     * @param bytes Arreglo destino de `bp.n_bytes` bytes.
+     */
+    const uint64_t *planes[BITS_ON_BYTE];
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++)
+        planes[k] = logical_plane(bp, k);
+
+    for (uint32_t w = 0; w < bp.n_words; w++) {
+        for (uint8_t g = 0; g < BITS_ON_BYTE; g++) {
+            uint32_t base = w*WORD_BITS + g*BITS_ON_BYTE;
+            uint64_t x = 0;
+
+            for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+                if (planes[k] != nullptr)
+                    x |= ((planes[k][w] >> (g*BITS_ON_BYTE)) & 0xFF) << (k*BITS_ON_BYTE);
+            }
+
+            x = transpose_8x8(x);
+
+            for (uint8_t j = 0; j < BITS_ON_BYTE && (base + j) < bp.n_bytes; j++)
+                bytes[base + j] = (x >> (j*BITS_ON_BYTE)) & 0xFF;
+        }
+    }
+}
+
+void bit_planes_window(const bit_planes &bp, const uint32_t offset, bit_planes &window)
+{
+    /**
+     * @brief Extrae una ventana de `window.n_bytes` bytes que empieza en el byte `offset`.
+     *
+     * La ventana queda alineada al bit 0 de sus planos, con correspondencia identidad y los bits
+     * sobrantes de la última palabra en cero, lista para compararse con una máscara.
+     *
+     * @param bp Planos de origen (por ejemplo, la imagen completa).
+     * @param offset Byte inicial de la ventana dentro de `bp`.
+     * @param window Planos destino, inicializados con el tamaño de la ventana.
+     */
+    uint32_t first_word = offset / WORD_BITS;
+    uint8_t bit_shift = offset % WORD_BITS;
+    uint32_t tail_bits = window.n_bytes % WORD_BITS;
+    uint64_t tail_mask = tail_bits ? ((uint64_t)1 << tail_bits) - 1 : ~(uint64_t)0;
+
+    reset_map(window);
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        const uint64_t *src = logical_plane(bp, k);
+        uint64_t *dst = window.data + k*window.n_words;
+
+        if (src == nullptr) {
+            memset(dst, 0, window.n_words*sizeof(uint64_t));
+            continue;
+        }
+
+        for (uint32_t w = 0; w < window.n_words; w++) {
+            uint32_t q = first_word + w;
+            uint64_t lo = (q < bp.n_words) ? src[q] : 0;
+            uint64_t hi = (q + 1 < bp.n_words) ? src[q + 1] : 0;
+
+            dst[w] = bit_shift ? ((lo >> bit_shift) | (hi << (WORD_BITS - bit_shift))) : lo;
+        }
+
+        dst[window.n_words - 1] &= tail_mask;
+    }
+}
+
+void bit_planes_rotate_left(bit_planes &bp, const uint8_t n)
+{
+    /**
+     * @brief Rota a la izquierda `n` bits todos los bytes reetiquetando los planos.
+     *
+     * El bit k del resultado es el bit (k - n) mod 8 original, así que basta con permutar la
+     * correspondencia de planos; no se recorre la imagen.
+     *
+     * @param bp Planos a rotar.
+     * @param n Número de posiciones a rotar (0 a 8).
+     */
+    uint8_t map[BITS_ON_BYTE];
+    bool zero[BITS_ON_BYTE];
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        map[k] = bp.map[(k - n) & (BITS_ON_BYTE - 1)];
+        zero[k] = bp.zero[(k - n) & (BITS_ON_BYTE - 1)];
+    }
+
+    memcpy(bp.map, map, sizeof(map));
+    memcpy(bp.zero, zero, sizeof(zero));
+}
+
+void bit_planes_rotate_right(bit_planes &bp, const uint8_t n)
+{
+    /**
+     * @brief Rota a la derecha `n` bits todos los bytes reetiquetando los planos.
+     *
+     * @param bp Planos a rotar.
+     * @param n Número de posiciones a rotar (0 a 8).
+     */
+    bit_planes_rotate_left(bp, (BITS_ON_BYTE - (n % BITS_ON_BYTE)) % BITS_ON_BYTE);
+}
+
+void bit_planes_shift_left(bit_planes &bp, const uint8_t n)
+{
+    /**
+     * @brief Desplaza a la izquierda `n` bits todos los bytes reetiquetando los planos.
+     *
+     * Los planos que salen por la izquierda se reutilizan como los `n` planos bajos y se marcan en cero;
+     * su contenido solo se limpia si más adelante una operación XOR necesita escribir sobre ellos.
+     *
+     * @param bp Planos a desplazar.
+     * @param n Número de posiciones a desplazar (0 a 8).
+     */
+    uint8_t map[BITS_ON_BYTE];
+    bool zero[BITS_ON_BYTE];
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        if (k < n) {
+            map[k] = bp.map[BITS_ON_BYTE - n + k];
+            zero[k] = true;
+        } else {
+            map[k] = bp.map[k - n];
+            zero[k] = bp.zero[k - n];
+        }
+    }
+
+    memcpy(bp.map, map, sizeof(map));
+    memcpy(bp.zero, zero, sizeof(zero));
+}
+
+void bit_planes_shift_right(bit_planes &bp, const uint8_t n)
+{
+    /**
+     * @brief Desplaza a la derecha `n` bits todos los bytes reetiquetando los planos.
+     *
+     * Los planos que salen por la derecha se reutilizan como los `n` planos altos y se marcan en cero.
+     *
+     * @param bp Planos a desplazar.
+     * @param n Número de posiciones a desplazar (0 a 8).
+     */
+    uint8_t map[BITS_ON_BYTE];
+    bool zero[BITS_ON_BYTE];
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        if (k + n < BITS_ON_BYTE) {
+            map[k] = bp.map[k + n];
+            zero[k] = bp.zero[k + n];
+        } else {
+            map[k] = bp.map[k + n - BITS_ON_BYTE];
+            zero[k] = true;
+        }
+    }
+
+    memcpy(bp.map, map, sizeof(map));
+    memcpy(bp.zero, zero, sizeof(zero));
+}
+
+void bit_planes_xor(bit_planes &bp, const bit_planes &other)
+{
+    /**
+     * @brief Aplica XOR plano a plano entre `bp` y `other`, escribiendo el resultado en `bp`.
+     *
+     * Es la única operación que recorre los datos: 64 bytes de la imagen por palabra de cada plano.
+     * Los planos marcados en cero se materializan copiando el plano correspondiente de `other`.
+     *
+     * @param bp Planos a modificar.
+     * @param other Planos del mismo tamaño con los que se hace XOR (por ejemplo, la imagen de ruido).
+     */
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        uint64_t *dst = bp.data + bp.map[k]*bp.n_words;
+        const uint64_t *src = logical_plane(other, k);
+
+        if (bp.zero[k]) {
+            if (src != nullptr)
+                memcpy(dst, src, bp.n_words*sizeof(uint64_t));
+            else
+                memset(dst, 0, bp.n_words*sizeof(uint64_t));
+            bp.zero[k] = false;
+        } else if (src != nullptr) {
+            for (uint32_t w = 0; w < bp.n_words; w++)
+                dst[w] ^= src[w];
+        }
+    }
+}
+
+uint32_t bit_planes_validate_xor(const bit_planes &img_window, const bit_planes &noisy_window, const bit_planes &reversed_mask)
+{
+    /**
+     * @brief Equivalente en planos de `validate_xor`.
+     *
+     * @param img_window Ventana de la imagen transformada.
+     * @param noisy_window Ventana de la imagen de ruido.
+     * @param reversed_mask Máscara revertida en planos.
+     * @return Distancia total de Hamming entre (imagen XOR ruido) y la máscara revertida.
+     */
+    uint32_t total_hamm_dist = 0;
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        const uint64_t *img = img_window.data + k*img_window.n_words;
+        const uint64_t *noisy = noisy_window.data + k*noisy_window.n_words;
+        const uint64_t *mask = reversed_mask.data + k*reversed_mask.n_words;
+
+        for (uint32_t w = 0; w < reversed_mask.n_words; w++)
+            total_hamm_dist += __builtin_popcountll(img[w] ^ noisy[w] ^ mask[w]);
+    }
+
+    return total_hamm_dist;
+}
+
+uint32_t bit_planes_validate_rotate_shift(const uint8_t op_code, const bit_planes &img_window,
+                                          const bit_planes &reversed_mask, const uint8_t n)
+{
+    /**
+     * @brief Equivalente en planos de `validate_rotate_shift_process`.
+     *
+     * Aplicar la rotación o desplazamiento a la máscara es solo elegir qué plano de la máscara se compara
+     * con cada plano de la ventana; los planos que la operación deja en cero se comparan contra nada.
+     *
+     * @param op_code Operación a evaluar (ROR_OP, ROL_OP, SHL_OP o SHR_OP).
+     * @param img_window Ventana de la imagen transformada.
+     * @param reversed_mask Máscara revertida en planos.
+     * @param n Número de bits de la operación (0 a 8).
+     * @return Distancia total de Hamming entre op(máscara) y la ventana de la imagen.
+     */
+    uint32_t total_hamm_dist = 0;
+
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        int8_t src = -1;
+
+        switch (op_code) {
+        case ROR_OP:
+            src = (k + n) & (BITS_ON_BYTE - 1);
+            break;
+        case ROL_OP:
+            src = (k - n) & (BITS_ON_BYTE - 1);
+            break;
+        case SHL_OP:
+            src = (k >= n) ? (k - n) : -1;
+            break;
+        case SHR_OP:
+            src = (k + n < BITS_ON_BYTE) ? (k + n) : -1;
+            break;
+        }
+
+        total_hamm_dist += plane_distance(img_window.data + k*img_window.n_words,
+                                          (src < 0) ? nullptr : reversed_mask.data + src*reversed_mask.n_words,
+                                          reversed_mask.n_words);
+    }
+
+    return total_hamm_dist;
+}
+
+static uint32_t plane_distance(const uint64_t *plane_1, const uint64_t *plane_2, const uint32_t n_words)
+{
+    /**
+     * @brief Cuenta los bits diferentes entre dos planos; un plano nulo se interpreta como cero.
+     */
+    uint32_t dist = 0;
+
+    if (plane_2 == nullptr) {
+        for (uint32_t w = 0; w < n_words; w++)
+            dist += __builtin_popcountll(plane_1[w]);
+    } else {
+        for (uint32_t w = 0; w < n_words; w++)
+            dist += __builtin_popcountll(plane_1[w] ^ plane_2[w]);
+    }
+
+    return dist;
+}
+
+static const uint64_t *logical_plane(const bit_planes &bp, const uint8_t k)
+{
+    /**
+     * @brief Devuelve el plano físico del plano lógico k, o nullptr si vale cero.
+     */
+    return bp.zero[k] ? nullptr : bp.data + bp.map[k]*bp.n_words;
+}
+
+static void reset_map(bit_planes &bp)
+{
+    /**
+     * @brief Restablece la correspondencia identidad entre planos lógicos y físicos.
+     */
+    for (uint8_t k = 0; k < BITS_ON_BYTE; k++) {
+        bp.map[k] = k;
+        bp.zero[k] = false;
+    }
+}
+
+static uint64_t transpose_8x8(uint64_t x)
+{
+    /**
+     * @brief Transpone una matriz de 8x8 bits almacenada en una palabra (fila r en el byte r).
+     *
+     * Tras la transposición, el bit c del byte r es el bit r del byte c original.
+     * Algoritmo de intercambio por bloques (Hacker's Delight, sección 7-3).
+     */
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+
+    return x;
+}
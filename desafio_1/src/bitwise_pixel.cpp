@@ -1,6 +1,7 @@
 #include <iostream>
 #include <stdint.h>
 #include <cassert>
+#include <cstring>
 #include "include/bitwise_pixel.hpp"
 #include "include/constants.hpp"
 
@@ -46,6 +47,179 @@ void apply_complete_xor(uint8_t *img_data, const uint8_t *img_noisy_data, const
         img_data[i] = xor_byte(img_data[i], img_noisy_data[i]);
 }
 
+void fused_chain_init(fused_chain &fc)
+{
+    /**
+     * @brief Inicializa una cadena compilada vacía (identidad sobre la imagen, sin aporte del ruido).
+     *
+     * @param fc Cadena a inicializar.
+     */
+    for (uint16_t x = 0; x < BYTE_VALUES; x++) {
+        fc.img_lut[x] = x;
+        fc.noisy_lut[x] = 0;
+    }
+    fc.uses_noise = false;
+}
+
+void fused_chain_reverse(fused_chain &fc, const uint8_t op, const uint8_t n)
+{
+    /**
+     * @brief Agrega a la cadena compilada la operación inversa de (`op`, `n`).
+     *
+     * Las rotaciones y desplazamientos son lineales sobre los bits del byte, por lo que se pueden aplicar por separado
+     * a las dos tablas: L(img_lut[a] ^ noisy_lut[b]) = L(img_lut[a]) ^ L(noisy_lut[b]). El XOR con la imagen de ruido
+     * solo suma la identidad a la tabla del ruido. Así, cualquier cadena se reduce a dos consultas de tabla por byte.
+     *
+     * @param fc Cadena compilada a actualizar.
+     * @param op Código de la operación original que se desea revertir (XOR, ROR, ROL, SHL, SHR).
+     * @param n Cantidad de bits utilizados originalmente en la operación.
+     */
+    uint8_t (*inverse)(const uint8_t, const uint8_t) = nullptr;
+
+    switch(op) {
+    case XOR_OP:
+        for (uint16_t x = 0; x < BYTE_VALUES; x++)
+            fc.noisy_lut[x] = xor_byte(fc.noisy_lut[x], x);
+        fc.uses_noise = true;
+        return;
+    case ROR_OP:
+        inverse = rotate_left_byte;
+        break;
+    case ROL_OP:
+        inverse = rotate_right_byte;
+        break;
+    case SHR_OP:
+        inverse = shift_left_byte;
+        break;
+    case SHL_OP:
+        inverse = shift_right_byte;
+        break;
+    default:
+        cout << "Valor de operación desconocido" << endl;
+        return;
+    }
+
+    for (uint16_t x = 0; x < BYTE_VALUES; x++) {
+        fc.img_lut[x] = inverse(fc.img_lut[x], n);
+        fc.noisy_lut[x] = inverse(fc.noisy_lut[x], n);
+    }
+}
+
+void fused_chain_forward(fused_chain &fc, const uint8_t op, const uint8_t n)
+{
+    /**
+     * @brief Agrega a la cadena compilada la operación (`op`, `n`) tal como se aplicó originalmente.
+     *
+     * Es el complemento de `fused_chain_reverse`: permite reconstruir las imágenes intermedias a partir de la
+     * imagen restaurada con dos consultas de tabla por byte.
+     *
+     * @param fc Cadena compilada a actualizar.
+     * @param op Código de la operación (XOR, ROR, ROL, SHL, SHR).
+     * @param n Cantidad de bits de la operación.
+     */
+    uint8_t (*forward)(const uint8_t, const uint8_t) = nullptr;
+
+    switch(op) {
+    case XOR_OP:
+        for (uint16_t x = 0; x < BYTE_VALUES; x++)
+            fc.noisy_lut[x] = xor_byte(fc.noisy_lut[x], x);
+        fc.uses_noise = true;
+        return;
+    case ROR_OP:
+        forward = rotate_right_byte;
+        break;
+    case ROL_OP:
+        forward = rotate_left_byte;
+        break;
+    case SHR_OP:
+        forward = shift_right_byte;
+        break;
+    case SHL_OP:
+        forward = shift_left_byte;
+        break;
+    default:
+        cout << "Valor de operación desconocido" << endl;
+        return;
+    }
+
+    for (uint16_t x = 0; x < BYTE_VALUES; x++) {
+        fc.img_lut[x] = forward(fc.img_lut[x], n);
+        fc.noisy_lut[x] = forward(fc.noisy_lut[x], n);
+    }
+}
+
+uint8_t fused_chain_kept_bits(const fused_chain &fc)
+{
+    /**
+     * @brief Bits de entrada que la cadena compilada conserva en la imagen resultante.
+     *
+     * Las operaciones son lineales y llevan cada bit a un solo bit de salida o lo descartan (desplazamientos),
+     * así que basta con aplicar la tabla a cada byte de un solo bit.
+     *
+     * @param fc Cadena compilada.
+     * @return Máscara con los bits cuyo valor llega a la salida; 0xFF si la cadena no tiene desplazamientos.
+     */
+    uint8_t kept = 0;
+
+    for (uint8_t b = 0; b < BITS_ON_BYTE; b++) {
+        if (fc.img_lut[1 << b] != 0)
+            kept |= (uint8_t)(1 << b);
+    }
+
+    return kept;
+}
+
+uint8_t fused_chain_output_bits(const fused_chain &fc)
+{
+    /**
+     * @brief Bits de la salida que dependen de la imagen de entrada.
+     *
+     * Los demás bits los puso en cero algún desplazamiento y a lo sumo llevan el aporte del ruido, así que no dicen
+     * nada de la imagen.
+     *
+     * @param fc Cadena compilada.
+     * @return Máscara con los bits de salida alcanzados por algún bit de entrada.
+     */
+    uint8_t reached = 0;
+
+    for (uint8_t b = 0; b < BITS_ON_BYTE; b++)
+        reached |= fc.img_lut[1 << b];
+
+    return reached;
+}
+
+bool fused_chain_equal(const fused_chain &a, const fused_chain &b)
+{
+    /**
+     * @brief Indica si dos cadenas compiladas producen el mismo resultado.
+     *
+     * Solo se comparan las tablas: una cadena cuyos XOR se cancelan entre sí o que un desplazamiento descarta deja
+     * `noisy_lut` en cero y sigue marcada con `uses_noise`, pero es equivalente a la misma cadena sin XOR.
+     */
+    return (memcmp(a.img_lut, b.img_lut, sizeof(a.img_lut)) == 0)
+           && (memcmp(a.noisy_lut, b.noisy_lut, sizeof(a.noisy_lut)) == 0);
+}
+
+void apply_fused_chain(const fused_chain &fc, uint8_t *img_data, const uint8_t *img_noisy_data, const uint32_t size)
+{
+    /**
+     * @brief Aplica toda la cadena compilada sobre una imagen en una sola pasada.
+     *
+     * @param fc Cadena compilada con `fused_chain_reverse` o `fused_chain_forward`.
+     * @param img_data Imagen a restaurar; se sobrescribe con el resultado.
+     * @param img_noisy_data Imagen de ruido usada por los pasos XOR de la cadena.
+     * @param size Número de bytes de la imagen (píxeles * RGB_CHANNELS).
+     */
+    if (!fc.uses_noise) {
+        for (uint32_t i = 0; i < size; i++)
+            img_data[i] = fc.img_lut[img_data[i]];
+        return;
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+        img_data[i] = fc.img_lut[img_data[i]] ^ fc.noisy_lut[img_noisy_data[i]];
+}
+
 uint32_t validate_rotate_shift_process(uint8_t(*op)(const uint8_t, const uint8_t), const uint8_t *img_data, const uint8_t *reversed_mask,
                                        const uint32_t seed, const uint32_t mask_size, const uint8_t n)
 {
@@ -0,0 +1,373 @@
+#include <stdint.h>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "include/bmp_io.hpp"
+#include "include/constants.hpp"
+
+#define BMP_HEADER_SIZE 54
+#define BMP_INFO_HEADER_SIZE 40
+#define BMP_MAX_HEADER_SIZE (64*1024)
+#define BMP_BITS_PER_PIXEL 24
+#define BMP_RGB 0
+#define BMP_BITFIELDS 3
+#define BMP_PALETTE_ENTRY 4
+
+static uint32_t read_le32(const uint8_t *p);
+static uint16_t read_le16(const uint8_t *p);
+static void write_le32(uint8_t *p, const uint32_t value);
+static void write_le16(uint8_t *p, const uint16_t value);
+static bool read_format(bmp_file &bf, const uint8_t *header);
+static void read_pixel(const bmp_file &bf, const uint8_t *row, const uint32_t x, uint8_t *rgb);
+static uint8_t mask_channel(const uint32_t pixel, const uint32_t mask);
+
+bool bmp_file_open(const char *path, bmp_file &bf)
+{
+    /**
+     * @brief Abre un archivo BMP para leerlo por filas y valida su cabecera.
+     *
+     * Se aceptan imágenes sin compresión de 24 bits (el formato de `I_D.bmp`, `I_M.bmp` y `M.bmp`), con paleta de
+     * 1, 4 u 8 bits (como `Caso 1/I_O.bmp`) y de 16 o 32 bits con o sin máscaras de color; los demás formatos se
+     * convierten a RGB888 al leerlos con `bmp_file_read_rgb`. No se aceptan BMP comprimidos (RLE, JPEG, PNG) ni
+     * cabeceras OS/2 de 12 bytes.
+     *
+     * Solo se guardan en memoria las cabeceras con la paleta: los píxeles se leen con `pread` a medida que se
+     * piden. A diferencia de un mapeo del archivo, las páginas leídas quedan en la caché
+     * del kernel y no cuentan en la memoria residente del proceso.
+     *
+     * @param path Ruta del archivo BMP.
+     * @param bf Estructura donde se guarda el descriptor y la geometría de la imagen.
+     * @return true si el archivo se pudo abrir y tiene un formato soportado; false en caso contrario.
+     */
+    uint8_t fixed[BMP_HEADER_SIZE];
+    struct stat st;
+
+    bf.fd = open(path, O_RDONLY);
+    bf.header = nullptr;
+
+    if (bf.fd < 0)
+        return false;
+
+    if ((fstat(bf.fd, &st) != 0) || (st.st_size < BMP_HEADER_SIZE)
+        || (pread(bf.fd, fixed, sizeof(fixed), 0) != (ssize_t)sizeof(fixed))) {
+        bmp_file_close(bf);
+        return false;
+    }
+
+    int32_t width = (int32_t)read_le32(fixed + 18);
+    int32_t height = (int32_t)read_le32(fixed + 22);
+    int32_t abs_height = (height < 0) ? -height : height;
+
+    bf.file_size = st.st_size;
+    bf.data_offset = read_le32(fixed + 10);
+    bf.top_down = height < 0;
+    bf.width = width;
+    bf.height = abs_height;
+    bf.bits = read_le16(fixed + 28);
+    bf.stride = ((bf.width*bf.bits + 31) / 32) * 4;
+
+    bool ok = (fixed[0] == 'B') && (fixed[1] == 'M') && (width > 0) && (width <= UINT16_MAX)
+              && (abs_height > 0) && (abs_height <= UINT16_MAX)
+              && (bf.data_offset >= BMP_HEADER_SIZE) && (bf.data_offset <= BMP_MAX_HEADER_SIZE)
+              && ((size_t)bf.data_offset + (size_t)bf.stride*bf.height <= bf.file_size);
+
+    //Las cabeceras y la paleta son todo lo que precede a la matriz de píxeles
+    if (ok) {
+        bf.header = new uint8_t[bf.data_offset];
+        ok = (pread(bf.fd, bf.header, bf.data_offset, 0) == (ssize_t)bf.data_offset) && read_format(bf, bf.header);
+    }
+
+    if (!ok)
+        bmp_file_close(bf);
+
+    return ok;
+}
+
+void bmp_file_close(bmp_file &bf)
+{
+    /**
+     * @brief Cierra el archivo BMP y libera la copia de las cabeceras.
+     *
+     * @param bf Archivo abierto con `bmp_file_open`.
+     */
+    if (bf.fd >= 0)
+        close(bf.fd);
+
+    delete[] bf.header;
+    bf.fd = -1;
+    bf.header = nullptr;
+}
+
+bool bmp_file_read_rgb(const bmp_file &bf, const uint32_t offset, const uint32_t size, uint8_t *out)
+{
+    /**
+     * @brief Lee un rango de bytes de la imagen como si estuviera en RGB888 plano de arriba hacia abajo.
+     *
+     * El rango se expresa en el mismo formato que devuelve `loadPixels` (R, G, B, R, G, B, ... sin relleno),
+     * así que puede reemplazar a un arreglo cargado completo. Cada fila del archivo que cubre el rango se lee
+     * con `pread` sobre un buffer de una fila y se convierte. Los bytes que caen fuera de la imagen se devuelven en
+     * cero. El buffer es propio de cada llamada, así que varios hilos pueden leer del mismo archivo a la vez.
+     *
+     * @param bf Archivo abierto con `bmp_file_open`.
+     * @param offset Primer byte a leer (en el formato RGB888 plano).
+     * @param size Número de bytes a leer.
+     * @param out Buffer de al menos `size` bytes donde se escriben los datos.
+     * @return true si se leyeron todas las filas; false si falló una lectura (el resto de `out` queda en cero).
+     */
+    uint32_t row_bytes = bf.width*RGB_CHANNELS;
+    uint32_t img_size = row_bytes*bf.height;
+    uint32_t pos = offset;
+    uint32_t end = offset + size;
+    uint8_t *row = new uint8_t[bf.stride];
+    bool ok = true;
+
+    while (ok && (pos < end)) {
+        if (pos >= img_size) {
+            memset(out + (pos - offset), 0, end - pos);
+            break;
+        }
+
+        uint32_t y = pos / row_bytes;
+        uint32_t col = pos % row_bytes;
+        uint32_t count = row_bytes - col;
+
+        if (count > end - pos)
+            count = end - pos;
+
+        uint8_t *dst = out + (pos - offset);
+        off_t file_row = bf.data_offset + (off_t)(bf.top_down ? y : (bf.height - 1 - y))*bf.stride;
+
+        if (pread(bf.fd, row, bf.stride, file_row) != (ssize_t)bf.stride) {
+            memset(dst, 0, end - pos);
+            ok = false;
+            break;
+        }
+
+        if (bf.bits == BMP_BITS_PER_PIXEL) {
+            //En el archivo cada píxel está en orden B, G, R
+            for (uint32_t j = 0; j < count; j++) {
+                uint32_t c = col + j;
+                dst[j] = row[c - (c % RGB_CHANNELS) + (BLUE_CHANNEL - (c % RGB_CHANNELS))];
+            }
+        } else {
+            uint8_t rgb[RGB_CHANNELS];
+
+            //Cada píxel se convierte una vez, aunque el rango empiece o termine en medio de él
+            for (uint32_t j = 0; j < count; j++) {
+                uint32_t c = col + j;
+                if ((j == 0) || (c % RGB_CHANNELS == 0))
+                    read_pixel(bf, row, c / RGB_CHANNELS, rgb);
+                dst[j] = rgb[c % RGB_CHANNELS];
+            }
+        }
+
+        pos += count;
+    }
+
+    delete[] row;
+    return ok;
+}
+
+bool bmp_write(const char *path, const uint8_t *pixel_data, const uint16_t width, const uint16_t height)
+{
+    /**
+     * @brief Guarda un arreglo RGB888 plano como BMP de 24 bits sin compresión.
+     *
+     * Se escribe fila por fila usando un único buffer del tamaño de una fila, sin crear una copia de la imagen.
+     *
+     * @param path Ruta del archivo de salida.
+     * @param pixel_data Arreglo de `width * height * 3` bytes (R, G, B, ... de arriba hacia abajo).
+     * @param width Ancho en píxeles.
+     * @param height Alto en píxeles.
+     * @return true si el archivo se escribió completo; false en caso contrario.
+     */
+    uint32_t stride = ((width*BMP_BITS_PER_PIXEL + 31) / 32) * 4;
+    uint32_t row_bytes = width*RGB_CHANNELS;
+    uint8_t header[BMP_HEADER_SIZE] = {0};
+
+    header[0] = 'B';
+    header[1] = 'M';
+    write_le32(header + 2, BMP_HEADER_SIZE + stride*height);
+    write_le32(header + 10, BMP_HEADER_SIZE);
+    write_le32(header + 14, BMP_HEADER_SIZE - 14);
+    write_le32(header + 18, width);
+    write_le32(header + 22, height);
+    write_le16(header + 26, 1);
+    write_le16(header + 28, BMP_BITS_PER_PIXEL);
+    write_le32(header + 34, stride*height);
+
+    FILE *file = fopen(path, "wb");
+
+    if (file == nullptr)
+        return false;
+
+    uint8_t *row = new uint8_t[stride]();
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    //Las filas se guardan de abajo hacia arriba y cada píxel en orden B, G, R
+    for (int32_t y = height - 1; ok && (y >= 0); y--) {
+        const uint8_t *src = pixel_data + y*row_bytes;
+
+        for (uint32_t x = 0; x < row_bytes; x += RGB_CHANNELS) {
+            row[x] = src[x + BLUE_CHANNEL];
+            row[x + GREEN_CHANNEL] = src[x + GREEN_CHANNEL];
+            row[x + BLUE_CHANNEL] = src[x + RED_CHANNEL];
+        }
+
+        ok = fwrite(row, 1, stride, file) == stride;
+    }
+
+    delete[] row;
+    return (fclose(file) == 0) && ok;
+}
+
+static bool read_format(bmp_file &bf, const uint8_t *header)
+{
+    /**
+     * @brief Valida la profundidad y la compresión de la cabecera y ubica la paleta o las máscaras de color.
+     *
+     * La paleta empieza después de la cabecera de información y tiene `biClrUsed` colores (2^bits si es cero).
+     * Con BI_BITFIELDS las máscaras R, G, B son los tres enteros que siguen a los 40 bytes de BITMAPINFOHEADER,
+     * tanto en esa cabecera como en las versiones 4 y 5, que las incluyen en esa misma posición. Todo está
+     * antes de la matriz de píxeles, así que se valida contra `data_offset`.
+     *
+     * @return true si el formato es uno de los soportados por `bmp_file_open`; false en caso contrario.
+     */
+    uint32_t info_size = read_le32(header + 14);
+    uint32_t compression = read_le32(header + 30);
+
+    bf.palette = nullptr;
+    bf.palette_size = 0;
+    bf.masks[RED_CHANNEL] = 0;
+    bf.masks[GREEN_CHANNEL] = 0;
+    bf.masks[BLUE_CHANNEL] = 0;
+
+    if ((info_size < BMP_INFO_HEADER_SIZE) || ((size_t)14 + info_size > bf.data_offset))
+        return false;
+
+    if (bf.bits == BMP_BITS_PER_PIXEL)
+        return compression == BMP_RGB;
+
+    if ((bf.bits == 1) || (bf.bits == 2) || (bf.bits == 4) || (bf.bits == 8)) {
+        uint32_t used = read_le32(header + 46);
+
+        bf.palette_size = ((used == 0) || (used > (1u << bf.bits))) ? (1u << bf.bits) : used;
+        bf.palette = header + 14 + info_size;
+
+        //Una paleta truncada se recorta a los colores que caben antes de los píxeles
+        if ((size_t)(bf.palette - header) + (size_t)bf.palette_size*BMP_PALETTE_ENTRY > bf.data_offset)
+            bf.palette_size = (bf.data_offset - (bf.palette - header)) / BMP_PALETTE_ENTRY;
+
+        return (compression == BMP_RGB) && (bf.palette_size > 0);
+    }
+
+    if ((bf.bits != 16) && (bf.bits != 32))
+        return false;
+
+    if (compression == BMP_BITFIELDS) {
+        if ((size_t)BMP_HEADER_SIZE + RGB_CHANNELS*4 > bf.data_offset)
+            return false;
+        bf.masks[RED_CHANNEL] = read_le32(header + BMP_HEADER_SIZE);
+        bf.masks[GREEN_CHANNEL] = read_le32(header + BMP_HEADER_SIZE + 4);
+        bf.masks[BLUE_CHANNEL] = read_le32(header + BMP_HEADER_SIZE + 8);
+    } else if (compression != BMP_RGB) {
+        return false;
+    } else if (bf.bits == 16) {
+        //X1R5G5B5, el formato por defecto de 16 bits
+        bf.masks[RED_CHANNEL] = 0x7C00;
+        bf.masks[GREEN_CHANNEL] = 0x03E0;
+        bf.masks[BLUE_CHANNEL] = 0x001F;
+    } else {
+        bf.masks[RED_CHANNEL] = 0x00FF0000;
+        bf.masks[GREEN_CHANNEL] = 0x0000FF00;
+        bf.masks[BLUE_CHANNEL] = 0x000000FF;
+    }
+
+    return true;
+}
+
+static void read_pixel(const bmp_file &bf, const uint8_t *row, const uint32_t x, uint8_t *rgb)
+{
+    /**
+     * @brief Convierte el píxel `x` de una fila del archivo a R, G, B para los formatos distintos de 24 bits.
+     *
+     * Los índices fuera de la paleta se leen como negro.
+     */
+    if (bf.palette != nullptr) {
+        uint32_t bit = x*bf.bits;
+        uint32_t index = (row[bit / 8] >> (8 - bf.bits - (bit % 8))) & ((1u << bf.bits) - 1);
+
+        if (index >= bf.palette_size) {
+            rgb[RED_CHANNEL] = rgb[GREEN_CHANNEL] = rgb[BLUE_CHANNEL] = 0;
+            return;
+        }
+
+        //Cada color de la paleta está en orden B, G, R, 0
+        const uint8_t *color = bf.palette + index*BMP_PALETTE_ENTRY;
+        rgb[RED_CHANNEL] = color[2];
+        rgb[GREEN_CHANNEL] = color[1];
+        rgb[BLUE_CHANNEL] = color[0];
+        return;
+    }
+
+    uint32_t pixel = (bf.bits == 16) ? read_le16(row + x*2) : read_le32(row + x*4);
+
+    for (uint8_t c = 0; c < RGB_CHANNELS; c++)
+        rgb[c] = mask_channel(pixel, bf.masks[c]);
+}
+
+static uint8_t mask_channel(const uint32_t pixel, const uint32_t mask)
+{
+    /**
+     * @brief Extrae un canal con su máscara y lo escala a 8 bits (por ejemplo, 5 bits de 0 a 31 pasan a 0 a 255).
+     */
+    if (mask == 0)
+        return 0;
+
+    uint32_t shift = __builtin_ctz(mask);
+    uint32_t width = __builtin_popcount(mask);
+    uint32_t value = (pixel & mask) >> shift;
+
+    if (width >= 8)
+        return value >> (width - 8);
+
+    return (value*255 + ((1u << width) - 1) / 2) / ((1u << width) - 1);
+}
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    /**
+     * @brief Lee un entero de 32 bits en little-endian sin requerir alineación.
+     */
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *p)
+{
+    /**
+     * @brief Lee un entero de 16 bits en little-endian sin requerir alineación.
+     */
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void write_le32(uint8_t *p, const uint32_t value)
+{
+    /**
+     * @brief Escribe un entero de 32 bits en little-endian sin requerir alineación.
+     */
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+}
+
+static void write_le16(uint8_t *p, const uint16_t value)
+{
+    /**
+     * @brief Escribe un entero de 16 bits en little-endian sin requerir alineación.
+     */
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+}
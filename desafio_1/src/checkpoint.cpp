@@ -0,0 +1,303 @@
+#include <stdint.h>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "include/checkpoint.hpp"
+#include "include/constants.hpp"
+
+using namespace std;
+
+#define CHECKPOINT_MAGIC 0x32433152 // "R1C2": cabecera con la huella de las entradas
+#define FNV_OFFSET_BASIS 2166136261u
+
+static uint32_t fnv1a(const uint8_t *data, const uint32_t size, uint32_t hash);
+static uint32_t snapshot_checksum(const uint8_t *snapshot, const uint32_t size);
+static void write_snapshot(checkpoint_writer *cw);
+
+void checkpoint_fingerprint(checkpoint_inputs &inputs, const uint8_t *img_data, const uint32_t img_size,
+                            const noise_source &noise, const bool noise_generated)
+{
+    /**
+     * @brief Calcula la huella de las entradas que determinan el resultado de la reversión.
+     *
+     * Se guarda en cada checkpoint y se compara al reanudar: un checkpoint de otra imagen `I_D.bmp` o de otro
+     * ruido tiene las mismas dimensiones y pasa la suma de verificación, pero reanudarlo produce una imagen
+     * incorrecta. El ruido generado se identifica por su semilla; el de archivo, por el hash de sus píxeles,
+     * que se leen por bloques si la fuente no está completa en memoria.
+     *
+     * @param inputs Huella calculada.
+     * @param img_data Píxeles de `I_D.bmp` tal como se cargaron, antes de revertir cualquier etapa.
+     * @param img_size Tamaño de la imagen en bytes.
+     * @param noise Fuente del ruido, con las mismas dimensiones que la imagen.
+     * @param noise_generated true si el ruido se genera con Philox4x32-10.
+     */
+    inputs.target_hash = fnv1a(img_data, img_size, FNV_OFFSET_BASIS);
+    inputs.noise_generated = noise_generated ? 1 : 0;
+
+    if (noise_generated) {
+        inputs.noise_id = noise.key;
+        return;
+    }
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    if (noise.data != nullptr) {
+        hash = fnv1a(noise.data, img_size, hash);
+    } else {
+        uint8_t *chunk = new uint8_t[NOISE_CHUNK_SIZE];
+
+        for (uint32_t pos = 0; pos < img_size; pos += NOISE_CHUNK_SIZE) {
+            uint32_t count = (img_size - pos < NOISE_CHUNK_SIZE) ? img_size - pos : NOISE_CHUNK_SIZE;
+            hash = fnv1a(noise_source_window(noise, pos, count, chunk), count, hash);
+        }
+        delete[] chunk;
+    }
+
+    inputs.noise_id = hash;
+}
+
+bool checkpoint_init(checkpoint_writer &cw, const uint16_t width, const uint16_t height, const uint8_t n_total,
+                     const checkpoint_inputs &inputs)
+{
+    /**
+     * @brief Prepara el escritor de checkpoints para una imagen y una cadena de tamaño dado.
+     *
+     * Reserva un único buffer con espacio para la cabecera, las `n_total` operaciones y una copia
+     * completa de la imagen. El buffer se reutiliza en cada checkpoint, de modo que el ciclo principal
+     * no vuelve a reservar memoria.
+     *
+     * @param cw Escritor a inicializar.
+     * @param width Ancho de la imagen en píxeles.
+     * @param height Alto de la imagen en píxeles.
+     * @param n_total Número total de etapas de la cadena.
+     * @param inputs Huella de las entradas (`checkpoint_fingerprint`), que se guarda en la cabecera.
+     * @return true si se pudo reservar el snapshot; false en caso contrario.
+     */
+    cw.busy.store(false);
+    cw.snapshot_size = sizeof(checkpoint_header) + n_total*sizeof(stage_op) + width*height*RGB_CHANNELS;
+    cw.snapshot = new (nothrow) uint8_t[cw.snapshot_size];
+
+    if (cw.snapshot == nullptr)
+        return false;
+
+    checkpoint_header *header = reinterpret_cast<checkpoint_header *>(cw.snapshot);
+    header->magic = CHECKPOINT_MAGIC;
+    header->width = width;
+    header->height = height;
+    header->n_total = n_total;
+    header->next_stage = n_total;
+    header->reserved = 0;
+    header->checksum = 0;
+    header->inputs = inputs;
+
+    return true;
+}
+
+bool checkpoint_save_async(checkpoint_writer &cw, const uint8_t *img_data, const stage_op *ops, const uint8_t next_stage)
+{
+    /**
+     * @brief Toma un snapshot de la imagen y de las operaciones detectadas y lo escribe en segundo plano.
+     *
+     * Si la escritura anterior todavía no ha terminado el checkpoint se omite, así el ciclo de reversión
+     * nunca espera por el disco. El único costo en el hilo principal es copiar la imagen al snapshot.
+     *
+     * @param cw Escritor previamente inicializado con `checkpoint_init`.
+     * @param img_data Imagen con las etapas `n_total..next_stage+1` ya revertidas.
+     * @param ops Operaciones detectadas, indexadas por etapa (`ops[i-1]` es la etapa `i`).
+     * @param next_stage Próxima etapa que falta por revertir.
+     * @return true si se lanzó la escritura; false si se omitió por estar ocupado el escritor.
+     */
+    if (cw.busy.load())
+        return false;
+
+    if (cw.worker.joinable())
+        cw.worker.join();
+
+    checkpoint_header *header = reinterpret_cast<checkpoint_header *>(cw.snapshot);
+    uint8_t *ops_data = cw.snapshot + sizeof(checkpoint_header);
+    uint32_t ops_size = header->n_total*sizeof(stage_op);
+
+    header->next_stage = next_stage;
+    memcpy(ops_data, ops, ops_size);
+    memcpy(ops_data + ops_size, img_data, header->width*header->height*RGB_CHANNELS);
+
+    cw.busy.store(true);
+    cw.worker = thread(write_snapshot, &cw);
+
+    return true;
+}
+
+void checkpoint_finish(checkpoint_writer &cw)
+{
+    /**
+     * @brief Espera a que termine la escritura pendiente y libera el snapshot.
+     *
+     * @param cw Escritor a finalizar.
+     */
+    if (cw.worker.joinable())
+        cw.worker.join();
+
+    delete[] cw.snapshot;
+    cw.snapshot = nullptr;
+}
+
+bool checkpoint_load(const char *path, uint8_t *img_data, stage_op *ops, const uint16_t width,
+                     const uint16_t height, const uint8_t n_total, const checkpoint_inputs &inputs,
+                     uint8_t &next_stage)
+{
+    /**
+     * @brief Carga el último checkpoint consistente sobre la imagen y el arreglo de operaciones.
+     *
+     * El archivo se mapea en memoria de solo lectura y se valida la cabecera (formato, dimensiones y
+     * número de etapas), la suma de verificación y la huella de las entradas antes de copiar cualquier dato.
+     *
+     * @param path Ruta del archivo de checkpoint.
+     * @param img_data Buffer de la imagen donde se restaurará el snapshot.
+     * @param ops Arreglo de `n_total` operaciones donde se restaurarán las etapas ya detectadas.
+     * @param width Ancho esperado de la imagen.
+     * @param height Alto esperado de la imagen.
+     * @param n_total Número de etapas esperado.
+     * @param inputs Huella de las entradas de esta ejecución; debe coincidir con la del checkpoint.
+     * @param next_stage Parámetro de salida con la próxima etapa que falta por revertir.
+     * @return true si el checkpoint es válido y fue restaurado; false en caso contrario.
+     */
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        cout << "No existe un checkpoint en " << path << endl;
+        return false;
+    }
+
+    struct stat st;
+    uint32_t img_size = width*height*RGB_CHANNELS;
+    uint32_t ops_size = n_total*sizeof(stage_op);
+    uint32_t expected_size = sizeof(checkpoint_header) + ops_size + img_size;
+
+    if (fstat(fd, &st) != 0 || st.st_size != expected_size) {
+        cout << "El checkpoint no corresponde a las imágenes o al número de operaciones" << endl;
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, expected_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        cout << "No se pudo mapear el checkpoint" << endl;
+        return false;
+    }
+
+    const uint8_t *data = static_cast<const uint8_t *>(map);
+    checkpoint_header header;
+    memcpy(&header, data, sizeof(header));
+
+    bool ok = (header.magic == CHECKPOINT_MAGIC) && (header.width == width) && (header.height == height)
+              && (header.n_total == n_total) && (header.next_stage <= n_total)
+              && (header.checksum == snapshot_checksum(data, expected_size));
+
+    if (ok && ((header.inputs.target_hash != inputs.target_hash) || (header.inputs.noise_id != inputs.noise_id)
+               || (header.inputs.noise_generated != inputs.noise_generated))) {
+        cout << "El checkpoint se guardó con otra imagen I_D.bmp o con otro ruido" << endl;
+        munmap(map, expected_size);
+        return false;
+    }
+
+    if (ok) {
+        memcpy(ops, data + sizeof(header), ops_size);
+        memcpy(img_data, data + sizeof(header) + ops_size, img_size);
+        next_stage = header.next_stage;
+    } else {
+        cout << "El checkpoint está incompleto o no corresponde a esta cadena" << endl;
+    }
+
+    munmap(map, expected_size);
+    return ok;
+}
+
+static void write_snapshot(checkpoint_writer *cw)
+{
+    /**
+     * @brief Escribe el snapshot en disco a través de un archivo mapeado en memoria.
+     *
+     * Se escribe primero sobre `CHECKPOINT_TMP_PATH` y al final se renombra a `CHECKPOINT_PATH`,
+     * por lo que el checkpoint visible siempre es el último que se completó.
+     *
+     * @param cw Escritor cuyo snapshot se va a persistir. Se marca como libre al terminar.
+     */
+    checkpoint_header *header = reinterpret_cast<checkpoint_header *>(cw->snapshot);
+    header->checksum = snapshot_checksum(cw->snapshot, cw->snapshot_size);
+
+    int fd = open(CHECKPOINT_TMP_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0) {
+        cout << "No se pudo crear el archivo de checkpoint" << endl;
+        cw->busy.store(false);
+        return;
+    }
+
+    if (ftruncate(fd, cw->snapshot_size) != 0) {
+        cout << "No se pudo reservar espacio para el checkpoint" << endl;
+        close(fd);
+        cw->busy.store(false);
+        return;
+    }
+
+    void *map = mmap(nullptr, cw->snapshot_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        cout << "No se pudo mapear el archivo de checkpoint" << endl;
+        cw->busy.store(false);
+        return;
+    }
+
+    memcpy(map, cw->snapshot, cw->snapshot_size);
+    msync(map, cw->snapshot_size, MS_SYNC);
+    munmap(map, cw->snapshot_size);
+
+    rename(CHECKPOINT_TMP_PATH, CHECKPOINT_PATH);
+    cw->busy.store(false);
+}
+
+static uint32_t snapshot_checksum(const uint8_t *snapshot, const uint32_t size)
+{
+    /**
+     * @brief Suma de verificación de un snapshot completo: cabecera (con el campo `checksum` en cero),
+     * operaciones e imagen.
+     *
+     * Incluir la cabecera evita que un `next_stage` corrupto pase la validación y se reanude desde otra etapa.
+     *
+     * @param snapshot Inicio del snapshot (cabecera seguida de los datos).
+     * @param size Tamaño total del snapshot en bytes.
+     * @return uint32_t Hash FNV-1a del snapshot.
+     */
+    checkpoint_header header;
+
+    memcpy(&header, snapshot, sizeof(header));
+    header.checksum = 0;
+
+    uint32_t hash = fnv1a(reinterpret_cast<const uint8_t *>(&header), sizeof(header), FNV_OFFSET_BASIS);
+    return fnv1a(snapshot + sizeof(header), size - sizeof(header), hash);
+}
+
+static uint32_t fnv1a(const uint8_t *data, const uint32_t size, uint32_t hash)
+{
+    /**
+     * @brief Continúa el hash FNV-1a de 32 bits sobre un bloque de memoria.
+     *
+     * @param data Puntero a los datos.
+     * @param size Cantidad de bytes.
+     * @param hash Hash acumulado hasta ahora (FNV_OFFSET_BASIS para empezar).
+     * @return uint32_t Hash de los datos.
+     */
+    for (uint32_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
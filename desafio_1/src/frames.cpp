@@ -0,0 +1,206 @@
+#include <stdint.h>
+#include <cstdio>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "include/frames.hpp"
+#include "include/bmp_io.hpp"
+#include "include/img_alloc.hpp"
+#include "include/constants.hpp"
+
+using namespace std;
+
+#define FRAME_NAME_SIZE 32
+
+static void frame_worker(const fused_chain *fc, const uint8_t *img_noisy_data, const uint16_t width, const uint16_t height,
+                         const uint32_t first, const uint32_t step, const uint32_t n_frames,
+                         atomic<uint32_t> *n_done, atomic<uint32_t> *n_failed, mutex *io_mutex);
+static uint8_t *load_frame(const char *path, uint16_t &width, uint16_t &height, mutex *io_mutex);
+static bool write_frame(const uint8_t *frame_data, const uint16_t width, const uint16_t height, const char *path,
+                        mutex *io_mutex);
+
+bool process_frames(const stage_op *ops, const uint8_t n, const uint8_t *img_noisy_data,
+                        const uint16_t width, const uint16_t height, const uint32_t n_frames)
+{
+    /**
+     * @brief Revierte una secuencia de cuadros `I_D<k>.bmp` con la cadena ya detectada para `I_D.bmp`.
+     *
+     * La cadena se compila una sola vez en dos tablas de 256 entradas (ver `fused_chain_reverse`), de modo que
+     * cada cuadro se restaura con una única pasada en lugar de repetir la detección y las `n` pasadas de `app_img`.
+     * Los cuadros se reparten entre tantos hilos como núcleos haya disponibles y cada resultado se exporta
+     * como `I_O<k>.bmp`. Al final se informa el rendimiento en cuadros por segundo.
+     *
+     * @param ops Operaciones detectadas, indexadas por etapa (`ops[i-1]` es la etapa `i`).
+     * @param n Número de etapas de la cadena.
+     * @param img_noisy_data Imagen de ruido `I_M.bmp` compartida por todos los cuadros.
+     * @param width Ancho de la imagen de ruido; todos los cuadros deben tener estas dimensiones.
+     * @param height Alto de la imagen de ruido.
+     * @param n_frames Número de cuadros a procesar (`I_D0.bmp` a `I_D<n_frames-1>.bmp`).
+     * @return true si todos los cuadros se restauraron y exportaron; false si alguno no se pudo cargar, no tiene
+     * las dimensiones de `I_M.bmp` o no se pudo guardar.
+     */
+    fused_chain fc;
+    fused_chain_init(fc);
+
+    //La reversión se aplica desde la última etapa hasta la primera
+    for (uint8_t i = n; i > 0; i--)
+        fused_chain_reverse(fc, ops[i-1].op_code, ops[i-1].n);
+
+    uint32_t n_threads = thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+    if (n_threads > n_frames)
+        n_threads = n_frames;
+
+    atomic<uint32_t> n_done(0);
+    atomic<uint32_t> n_failed(0);
+    mutex io_mutex;
+    thread *workers = new thread[n_threads];
+
+    auto start = chrono::steady_clock::now();
+
+    for (uint32_t t = 0; t < n_threads; t++)
+        workers[t] = thread(frame_worker, &fc, img_noisy_data, width, height, t, n_threads, n_frames, &n_done, &n_failed,
+                            &io_mutex);
+
+    for (uint32_t t = 0; t < n_threads; t++)
+        workers[t].join();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    delete[] workers;
+
+    cout << "Se restauraron " << n_done.load() << " de " << n_frames << " cuadros en " << seconds << " s ("
+         << (seconds > 0 ? n_done.load() / seconds : 0) << " cuadros/s, " << n_threads << " hilos)" << endl;
+
+    return n_failed.load() == 0;
+}
+
+static void frame_worker(const fused_chain *fc, const uint8_t *img_noisy_data, const uint16_t width, const uint16_t height,
+                         const uint32_t first, const uint32_t step, const uint32_t n_frames,
+                         atomic<uint32_t> *n_done, atomic<uint32_t> *n_failed, mutex *io_mutex)
+{
+    /**
+     * @brief Restaura los cuadros `first`, `first + step`, ... aplicando la cadena compilada.
+     *
+     * La carga, la pasada de la cadena y la escritura de cada cuadro se hacen en paralelo; `io_mutex` solo
+     * serializa los mensajes de consola. Los cuadros que fallan se cuentan en `n_failed`.
+     *
+     * @param fc Cadena compilada compartida (solo lectura).
+     * @param img_noisy_data Imagen de ruido compartida (solo lectura).
+     * @param width Ancho esperado de cada cuadro.
+     * @param height Alto esperado de cada cuadro.
+     * @param first Primer cuadro asignado a este hilo.
+     * @param step Número total de hilos.
+     * @param n_frames Número total de cuadros.
+     * @param n_done Contador de cuadros restaurados correctamente.
+     * @param n_failed Contador de cuadros que no se pudieron cargar, no tienen las dimensiones esperadas o no se guardaron.
+     * @param io_mutex Mutex que protege la salida por consola.
+     */
+    char input[FRAME_NAME_SIZE];
+    char output[FRAME_NAME_SIZE];
+
+    for (uint32_t k = first; k < n_frames; k += step) {
+        uint16_t frame_width = 0;
+        uint16_t frame_height = 0;
+
+        snprintf(input, sizeof(input), "I_D%u.bmp", k);
+        snprintf(output, sizeof(output), "I_O%u.bmp", k);
+
+        uint8_t *frame_data = load_frame(input, frame_width, frame_height, io_mutex);
+
+        if (frame_data == nullptr) {
+            n_failed->fetch_add(1);
+            continue;
+        }
+
+        if ((frame_width != width) || (frame_height != height)) {
+            {
+                lock_guard<mutex> lock(*io_mutex);
+                cout << "El cuadro " << input << " no tiene las dimensiones de I_M.bmp" << endl;
+            }
+            n_failed->fetch_add(1);
+            img_free(frame_data);
+            continue;
+        }
+
+        apply_fused_chain(*fc, frame_data, img_noisy_data, width*height*RGB_CHANNELS);
+
+        if (write_frame(frame_data, width, height, output, io_mutex))
+            n_done->fetch_add(1);
+        else
+            n_failed->fetch_add(1);
+
+        img_free(frame_data);
+    }
+}
+
+static uint8_t *load_frame(const char *path, uint16_t &width, uint16_t &height, mutex *io_mutex)
+{
+    /**
+     * @brief Carga un cuadro como RGB888 e informa si falla.
+     *
+     * Se usa `bmp_file_open` en lugar de `loadPixels` porque este imprime en consola fuera de `io_mutex`; así la
+     * lectura queda en paralelo y solo el mensaje de error se serializa.
+     *
+     * @param path Ruta del cuadro.
+     * @param width Parámetro de salida con el ancho del cuadro.
+     * @param height Parámetro de salida con el alto del cuadro.
+     * @param io_mutex Mutex que protege la salida por consola.
+     * @return Píxeles del cuadro (liberar con `img_free`), o nullptr si no se pudo cargar.
+     */
+    bmp_file bf;
+
+    if (!bmp_file_open(path, bf)) {
+        lock_guard<mutex> lock(*io_mutex);
+        cout << "Error: No se pudo cargar el cuadro " << path << endl;
+        return nullptr;
+    }
+
+    width = bf.width;
+    height = bf.height;
+
+    uint32_t size = width*height*RGB_CHANNELS;
+    uint8_t *frame_data = static_cast<uint8_t *>(img_alloc(size));
+
+    if (frame_data == nullptr) {
+        lock_guard<mutex> lock(*io_mutex);
+        cout << "Error: No hay memoria para el cuadro " << path << endl;
+    } else if (!bmp_file_read_rgb(bf, 0, size, frame_data)) {
+        lock_guard<mutex> lock(*io_mutex);
+        cout << "Error: No se pudo leer el cuadro " << path << endl;
+        img_free(frame_data);
+        frame_data = nullptr;
+    }
+
+    bmp_file_close(bf);
+    return frame_data;
+}
+
+static bool write_frame(const uint8_t *frame_data, const uint16_t width, const uint16_t height, const char *path,
+                        mutex *io_mutex)
+{
+    /**
+     * @brief Escribe un cuadro restaurado como BMP e informa el resultado.
+     *
+     * Se usa `bmp_write` en lugar de `exportImage` porque este imprime en consola: así la codificación y la
+     * escritura, que son la parte más costosa de cada cuadro, quedan fuera del mutex.
+     *
+     * @param frame_data Píxeles RGB888 del cuadro.
+     * @param width Ancho del cuadro.
+     * @param height Alto del cuadro.
+     * @param path Ruta del archivo de salida.
+     * @param io_mutex Mutex que protege la salida por consola.
+     * @return true si el archivo se escribió correctamente.
+     */
+    bool ok = bmp_write(path, frame_data, width, height);
+    lock_guard<mutex> lock(*io_mutex);
+
+    if (ok)
+        cout << "Imagen BMP modificada guardada como " << path << endl;
+    else
+        cout << "Error: No se pudo guardar la imagen BMP " << path << endl;
+
+    return ok;
+}
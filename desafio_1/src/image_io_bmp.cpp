@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <iostream>
+#include "include/image_io.hpp"
+#include "include/bmp_io.hpp"
+#include "include/img_alloc.hpp"
+#include "include/constants.hpp"
+
+using namespace std;
+
+unsigned char* loadPixels(const char *input, uint16_t &width, uint16_t &height)
+{
+    /**
+     * @brief Carga una imagen BMP como arreglo RGB888 sin relleno, sin depender de Qt.
+     *
+     * Es la versión del núcleo de `loadPixels`: el archivo se abre con `bmp_file_open` y las filas se leen
+     * directamente al arreglo final. Se aceptan los BMP sin compresión que soporta `bmp_file_open`: 24 bits (el
+     * formato de las imágenes de entrada del reto), paleta de 1, 4 u 8 bits y 16 o 32 bits; todos se devuelven
+     * en RGB888, igual que el front end con Qt. A diferencia de QImage, no se leen BMP comprimidos.
+     *
+     * @param input Ruta del archivo de imagen BMP a cargar.
+     * @param width Parámetro de salida que contendrá el ancho de la imagen cargada (en píxeles).
+     * @param height Parámetro de salida que contendrá la altura de la imagen cargada (en píxeles).
+     * @return Puntero al arreglo con los píxeles (liberar con `img_free`), o nullptr si la imagen no pudo cargarse.
+     */
+    bmp_file bf;
+
+    if (!bmp_file_open(input, bf)) {
+        cout << "Error: No se pudo cargar la imagen BMP " << input << " (se requiere BMP sin compresión de 1, 4, 8, 16, 24 o 32 bits)." << endl;
+        return nullptr;
+    }
+
+    width = bf.width;
+    height = bf.height;
+
+    uint32_t size = width*height*RGB_CHANNELS;
+    unsigned char *pixelData = static_cast<unsigned char *>(img_alloc(size));
+
+    if (pixelData == nullptr) {
+        cout << "Error: No hay memoria para la imagen." << endl;
+    } else if (!bmp_file_read_rgb(bf, 0, size, pixelData)) {
+        cout << "Error: No se pudo leer la imagen BMP " << input << endl;
+        img_free(pixelData);
+        pixelData = nullptr;
+    }
+
+    bmp_file_close(bf);
+    return pixelData;
+}
+
+bool exportImage(unsigned char* pixelData, uint16_t width, uint16_t height, const char *archivoSalida)
+{
+    /**
+     * @brief Guarda un arreglo RGB888 como BMP de 24 bits, sin depender de Qt.
+     *
+     * @param pixelData Datos RGB de la imagen (width * height * 3 bytes, sin relleno).
+     * @param width Ancho de la imagen en píxeles.
+     * @param height Alto de la imagen en píxeles.
+     * @param archivoSalida Ruta del archivo de salida.
+     * @return true si la imagen se guardó exitosamente; false en caso contrario.
+     */
+    if (!bmp_write(archivoSalida, pixelData, width, height)) {
+        cout << "Error: No se pudo guardar la imagen BMP modificada." << endl;
+        return false;
+    }
+
+    cout << "Imagen BMP modificada guardada como " << archivoSalida << endl;
+    return true;
+}
@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <cstring>
+#include <iostream>
+#include <QCoreApplication>
+#include <QImage>
+#include "include/image_io.hpp"
+#include "include/img_alloc.hpp"
+
+using namespace std;
+
+unsigned char* loadPixels(const char *input, uint16_t &width, uint16_t &height)
+{
+    /*
+     * @brief Carga una imagen BMP desde un archivo y extrae los datos de píxeles en formato RGB.
+     *
+     * Esta función utiliza la clase QImage de Qt para abrir una imagen en formato BMP, convertirla al
+     * formato RGB888 (24 bits: 8 bits por canal), y copiar sus datos de píxeles a un arreglo dinámico
+     * de tipo unsigned char. El arreglo contendrá los valores de los canales Rojo, Verde y Azul (R, G, B)
+     * de cada píxel de la imagen, sin rellenos (padding).
+     *
+     * @param input Ruta del archivo de imagen BMP a cargar.
+     * @param width Parámetro de salida que contendrá el ancho de la imagen cargada (en píxeles).
+     * @param height Parámetro de salida que contendrá la altura de la imagen cargada (en píxeles).
+     * @return Puntero a un arreglo dinámico que contiene los datos de los píxeles en formato RGB.
+     *         Devuelve nullptr si la imagen no pudo cargarse.
+     *
+     * @note Es responsabilidad del usuario liberar la memoria asignada al arreglo devuelto usando `img_free`.
+     */
+
+    // Cargar la imagen BMP desde el archivo especificado (usando Qt)
+    QImage imagen(input);
+
+    // Verifica si la imagen fue cargada correctamente
+    if (imagen.isNull()) {
+        cout << "Error: No se pudo cargar la imagen BMP." << std::endl;
+        return nullptr; // Retorna un puntero nulo si la carga falló
+    }
+
+    // Convierte la imagen al formato RGB888 (3 canales de 8 bits sin transparencia)
+    imagen = imagen.convertToFormat(QImage::Format_RGB888);
+
+    // Obtiene el ancho y el alto de la imagen cargada
+    width = imagen.width();
+    height = imagen.height();
+
+    // Calcula el tamaño total de datos (3 bytes por píxel: R, G, B)
+    int dataSize = width * height * 3;
+
+    // Reserva memoria alineada (con páginas grandes si la imagen es grande) para los valores RGB de cada píxel
+    unsigned char* pixelData = static_cast<unsigned char *>(img_alloc(dataSize));
+
+    if (pixelData == nullptr) {
+        cout << "Error: No hay memoria para la imagen." << std::endl;
+        return nullptr;
+    }
+
+    // Copia cada línea de píxeles de la imagen Qt a nuestro arreglo lineal
+    for (int y = 0; y < height; ++y) {
+        const uchar* srcLine = imagen.scanLine(y);              // Línea original de la imagen con posible padding
+        unsigned char* dstLine = pixelData + y * width * 3;     // Línea destino en el arreglo lineal sin padding
+        memcpy(dstLine, srcLine, width * 3);                    // Copia los píxeles RGB de esa línea (sin padding)
+    }
+
+    // Retorna el puntero al arreglo de datos de píxeles cargado en memoria
+    return pixelData;
+}
+
+bool exportImage(unsigned char* pixelData, uint16_t width, uint16_t height, const char *archivoSalida)
+{
+    /*
+     * @brief Exporta una imagen en formato BMP a partir de un arreglo de píxeles en formato RGB.
+     *
+     * Esta función crea una imagen de tipo QImage utilizando los datos contenidos en el arreglo dinámico
+     * `pixelData`, que debe representar una imagen en formato RGB888 (3 bytes por píxel, sin padding).
+     * A continuación, copia los datos línea por línea a la imagen de salida y guarda el archivo resultante
+     * en formato BMP en la ruta especificada.
+     *
+     * @param pixelData Puntero a un arreglo de bytes que contiene los datos RGB de la imagen a exportar.
+     *                  El tamaño debe ser igual a width * height * 3 bytes.
+     * @param width Ancho de la imagen en píxeles.
+     * @param height Alto de la imagen en píxeles.
+     * @param archivoSalida Ruta y nombre del archivo de salida en el que se guardará la imagen BMP.
+     *
+     * @return true si la imagen se guardó exitosamente; false si ocurrió un error durante el proceso.
+     *
+     * @note La función no libera la memoria del arreglo pixelData; esta responsabilidad recae en el usuario.
+     */
+
+    // Crear una nueva imagen de salida con el mismo tamaño que la original
+    // usando el formato RGB888 (3 bytes por píxel, sin canal alfa)
+    QImage outputImage(width, height, QImage::Format_RGB888);
+
+    // Copiar los datos de píxeles desde el buffer al objeto QImage
+    for (int y = 0; y < height; ++y) {
+        // outputImage.scanLine(y) devuelve un puntero a la línea y-ésima de píxeles en la imagen
+        // pixelData + y * width * 3 apunta al inicio de la línea y-ésima en el buffer (sin padding)
+        // width * 3 son los bytes a copiar (3 por píxel)
+        memcpy(outputImage.scanLine(y), pixelData + y * width * 3, width * 3);
+    }
+
+    // Guardar la imagen en disco como archivo BMP
+    if (!outputImage.save(archivoSalida, "BMP")) {
+        // Si hubo un error al guardar, mostrar mensaje de error
+        cout << "Error: No se pudo guardar la imagen BMP modificada.";
+        return false; // Indica que la operación falló
+    } else {
+        // Si la imagen fue guardada correctamente, mostrar mensaje de éxito
+        cout << "Imagen BMP modificada guardada como " << archivoSalida << endl;
+        return true; // Indica éxito
+    }
+
+}
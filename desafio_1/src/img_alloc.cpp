@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "include/img_alloc.hpp"
+
+#define ALLOC_ALIGNMENT 64
+#define HUGE_PAGE_SIZE (2u*1024u*1024u)
+#define ALLOC_ALIGNED 0
+#define ALLOC_MAPPED 1
+#define NODE_MASK_BITS 1024
+
+/// Cabecera guardada justo antes del puntero entregado; ocupa ALLOC_ALIGNMENT bytes para no romper la alineación
+struct alloc_header {
+    size_t length;      ///< Bytes mapeados desde la base (ALLOC_MAPPED) o bytes pedidos (ALLOC_ALIGNED)
+    void *base;         ///< Dirección devuelta por mmap o posix_memalign
+    uint8_t kind;       ///< ALLOC_ALIGNED o ALLOC_MAPPED
+};
+
+static bool huge_pages_enabled = true;
+
+static void *map_huge(const size_t length);
+
+void img_alloc_set_huge_pages(const bool enabled)
+{
+    /**
+     * @brief Activa o desactiva el uso de páginas grandes en las reservas siguientes.
+     *
+     * Permite comparar con contadores de rendimiento la misma ejecución con y sin páginas grandes.
+     *
+     * @param enabled true para usar páginas grandes en los buffers de imagen.
+     */
+    huge_pages_enabled = enabled;
+}
+
+void *img_alloc(const size_t size)
+{
+    /**
+     * @brief Reserva un buffer de imagen o máscara alineado a 64 bytes.
+     *
+     * Los buffers de al menos una página grande (2 MiB) se reservan con mmap: primero se intenta con páginas
+     * grandes explícitas (MAP_HUGETLB) y, si el sistema no tiene reservadas, con una región alineada a 2 MiB
+     * marcada con MADV_HUGEPAGE para que el kernel use páginas grandes transparentes. Así cada pasada completa
+     * sobre la imagen toca pocas entradas de la TLB.
+     *
+     * La memoria no se inicializa: las páginas se asignan al nodo NUMA del hilo que las escribe primero, que es el
+     * mismo hilo que carga los datos y luego los recorre (por ejemplo, cada cuadro de `process_frames`). Los buffers
+     * compartidos entre hilos se reparten entre nodos con `img_alloc_interleave`.
+     *
+     * @param size Número de bytes a reservar.
+     * @return Puntero alineado a 64 bytes, o nullptr si no hay memoria. Debe liberarse con `img_free`.
+     */
+    size_t total = size + ALLOC_ALIGNMENT;
+    alloc_header header = {0, nullptr, ALLOC_ALIGNED};
+
+    if (huge_pages_enabled && (total >= HUGE_PAGE_SIZE)) {
+        header.length = (total + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+        header.base = map_huge(header.length);
+        header.kind = ALLOC_MAPPED;
+    }
+
+    if (header.base == nullptr) {
+        header.kind = ALLOC_ALIGNED;
+        if (posix_memalign(&header.base, ALLOC_ALIGNMENT, total) != 0)
+            return nullptr;
+        header.length = size;
+    }
+
+    *static_cast<alloc_header *>(header.base) = header;
+
+    return static_cast<uint8_t *>(header.base) + ALLOC_ALIGNMENT;
+}
+
+void img_free(void *ptr)
+{
+    /**
+     * @brief Libera un buffer reservado con `img_alloc`. Acepta nullptr.
+     *
+     * @param ptr Puntero devuelto por `img_alloc`.
+     */
+    if (ptr == nullptr)
+        return;
+
+    alloc_header *header = reinterpret_cast<alloc_header *>(static_cast<uint8_t *>(ptr) - ALLOC_ALIGNMENT);
+
+    if (header->kind == ALLOC_MAPPED)
+        munmap(header->base, header->length);
+    else
+        free(header->base);
+}
+
+bool img_alloc_interleave(void *ptr)
+{
+    /**
+     * @brief Reparte las páginas de un buffer entre todos los nodos NUMA permitidos (MPOL_INTERLEAVE).
+     *
+     * Es para buffers de solo lectura que comparten hilos de varios sockets, como la imagen de ruido de
+     * `process_frames`: con la política de primer contacto quedarían completos en el nodo del hilo que los cargó.
+     * Las páginas ya escritas se migran (MPOL_MF_MOVE). Con un solo nodo no se hace nada.
+     *
+     * Solo se aplica a buffers reservados con mmap (ALLOC_MAPPED), que son dueños de todo su rango. Un buffer de
+     * posix_memalign comparte páginas del heap con otras reservas, que se migrarían y cambiarían de política.
+     *
+     * @param ptr Puntero devuelto por `img_alloc`.
+     * @return true si se aplicó la política; false si hay un solo nodo, el buffer no es un mapeo propio o el
+     * kernel no soporta mbind.
+     */
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+    if (ptr == nullptr)
+        return false;
+
+    alloc_header *header = reinterpret_cast<alloc_header *>(static_cast<uint8_t *>(ptr) - ALLOC_ALIGNMENT);
+
+    if (header->kind != ALLOC_MAPPED)
+        return false;
+
+    unsigned long nodes[NODE_MASK_BITS / (8*sizeof(unsigned long))] = {0};
+    uint32_t n_nodes = 0;
+
+    if (syscall(SYS_get_mempolicy, nullptr, nodes, NODE_MASK_BITS, nullptr, MPOL_F_MEMS_ALLOWED) != 0)
+        return false;
+
+    for (size_t i = 0; i < sizeof(nodes) / sizeof(nodes[0]); i++)
+        n_nodes += __builtin_popcountl(nodes[i]);
+
+    if (n_nodes < 2)
+        return false;
+
+    //El mapeo empieza alineado a 2 MiB y su longitud es múltiplo de 2 MiB
+    return syscall(SYS_mbind, header->base, header->length, MPOL_INTERLEAVE, nodes, NODE_MASK_BITS,
+                   MPOL_MF_MOVE) == 0;
+#else
+    (void)ptr;
+    return false;
+#endif
+}
+
+static void *map_huge(const size_t length)
+{
+    /**
+     * @brief Reserva `length` bytes (múltiplo de 2 MiB) respaldados por páginas grandes si es posible.
+     *
+     * @param length Bytes a reservar.
+     * @return Dirección alineada a 2 MiB, o nullptr si mmap falla.
+     */
+#ifdef MAP_HUGETLB
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    if (base != MAP_FAILED)
+        return base;
+#endif
+
+    //Sin páginas grandes reservadas: se pide una región mayor y se recorta para alinearla a 2 MiB
+    uint8_t *region = static_cast<uint8_t *>(mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+    if (region == MAP_FAILED)
+        return nullptr;
+
+    uintptr_t aligned = ((uintptr_t)region + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    size_t head = aligned - (uintptr_t)region;
+
+    if (head > 0)
+        munmap(region, head);
+    munmap(reinterpret_cast<uint8_t *>(aligned) + length, HUGE_PAGE_SIZE - head);
+
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void *>(aligned), length, MADV_HUGEPAGE);
+#endif
+
+    return reinterpret_cast<void *>(aligned);
+}
@@ -3,17 +3,25 @@
  * El software utiliza 3 librerías de creación propia, se utilizó Chat-GPT para
  * generar comentarios compatibles con Doxygen.
  * Las imágenes deben agregarse en el mismo directorio donde está el ejecutable de la aplicación
- * Forma de ejecución por consola en Linux: ./reto_1 [num_operaciones]
+ * Forma de ejecución por consola en Linux: ./reto_1 [num_operaciones] [--resume] [--bit-planes] [--frames N]
+ *                                   [--no-huge-pages] [--perf] [--low-mem MiB] [--beam K] [--noise-seed S]
+ *                                   (K entre 1 y MAX_BEAM_WIDTH = 64)
+ * Verificación de la cadena guardada en cadena.txt:  ./reto_1 --verify [referencia.bmp] [--noise-seed S]
+ * Compilación: ProjectParams.pro (front end con Qt) o ProjectParamsCore.pro (núcleo sin Qt, enlazado estático).
  *
  * Realizado por: Yonathan López Mejía y Daniela Escobar Velandia.
  */
 
-#include <QCoreApplication>
-#include <QImage>
 #include <iostream>
+#include <cstdlib>
+#include <limits>
+#include <cstring>
+#include <cerrno>
 #include "include/bitwise_pixel.hpp"
 #include "include/process_data.hpp"
 #include "include/constants.hpp"
+#include "include/verify.hpp"
+#include "include/perf_counters.hpp"
 
 using namespace std;
 #define MAX_NUMBER_DIGITS 5
@@ -68,15 +76,178 @@ bool get_int8_t(char *num, int8_t &number)
     return true;
 }
 
+static bool get_count(const char *text, const uint32_t max, uint32_t &count)
+{
+    /**
+     * @brief Convierte el valor de una bandera numérica a un entero sin signo, validando todo el texto.
+     *
+     * A diferencia de `strtoul` sola, rechaza signos, caracteres sobrantes (por ejemplo `8x`) y valores
+     * que se desbordan, en lugar de truncarlos o interpretarlos como un número distinto.
+     *
+     * @param text Cadena con el valor de la bandera.
+     * @param max Valor máximo permitido.
+     * @param count Referencia donde se guarda el valor si es válido.
+     * @return true si el texto es un número entre 1 y `max`; false en caso contrario.
+     */
+    char *end = nullptr;
+    unsigned long value;
+
+    if ((*text < '0') || (*text > '9'))
+        return false;
+
+    errno = 0;
+    value = strtoul(text, &end, 10);
+    if ((*end != '\0') || (errno == ERANGE) || (value == 0) || (value > max))
+        return false;
+
+    count = static_cast<uint32_t>(value);
+
+    return true;
+}
+
+static bool get_seed(const char *text, uint64_t &seed)
+{
+    /**
+     * @brief Convierte la semilla del ruido (decimal, octal o hexadecimal con `0x`) validando todo el texto.
+     *
+     * @param text Cadena con la semilla.
+     * @param seed Referencia donde se guarda la semilla si es válida.
+     * @return true si el texto es un número de 64 bits sin signo ni caracteres sobrantes; false en caso contrario.
+     */
+    char *end = nullptr;
+    unsigned long long value;
+
+    if ((*text < '0') || (*text > '9'))
+        return false;
+
+    errno = 0;
+    value = strtoull(text, &end, 0);
+    if ((*end != '\0') || (errno == ERANGE))
+        return false;
+
+    seed = value;
+
+    return true;
+}
+
+static bool parse_options(int argc, char *argv[], app_options &opts)
+{
+    /**
+     * @brief Interpreta las banderas opcionales que siguen al número de operaciones.
+     *
+     * @param argc Número de argumentos recibidos por `main`.
+     * @param argv Argumentos recibidos por `main`. Las banderas empiezan en `argv[2]`.
+     * @param opts Estructura donde se guardan las opciones reconocidas.
+     * @return true si todas las banderas son válidas; false si alguna es desconocida.
+     */
+    opts.resume = false;
+    opts.bit_planes = false;
+    opts.frames = 0;
+    opts.huge_pages = true;
+    opts.perf = false;
+    opts.low_mem_budget = 0;
+    opts.beam_width = 0;
+    opts.noise_generated = false;
+    opts.noise_seed = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--resume") == 0) {
+            opts.resume = true;
+        } else if (strcmp(argv[i], "--bit-planes") == 0) {
+            opts.bit_planes = true;
+        } else if ((strcmp(argv[i], "--frames") == 0) && (i + 1 < argc)) {
+            if (!get_count(argv[++i], std::numeric_limits<uint32_t>::max(), opts.frames)) {
+                cout << "El número de cuadros debe ser un entero mayor que cero" << endl;
+                return false;
+            }
+        } else if (strcmp(argv[i], "--no-huge-pages") == 0) {
+            opts.huge_pages = false;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            opts.perf = true;
+        } else if ((strcmp(argv[i], "--low-mem") == 0) && (i + 1 < argc)) {
+            if (!get_count(argv[++i], std::numeric_limits<uint32_t>::max(), opts.low_mem_budget)) {
+                cout << "El presupuesto de memoria debe ser un entero mayor que cero" << endl;
+                return false;
+            }
+        } else if ((strcmp(argv[i], "--beam") == 0) && (i + 1 < argc)) {
+            //Cada etapa evalúa hasta 37 hijos por hipótesis, así que el haz se limita a MAX_BEAM_WIDTH
+            if (!get_count(argv[++i], MAX_BEAM_WIDTH, opts.beam_width)) {
+                cout << "El ancho del haz debe ser un entero entre 1 y " << MAX_BEAM_WIDTH << endl;
+                return false;
+            }
+        } else if ((strcmp(argv[i], "--noise-seed") == 0) && (i + 1 < argc)) {
+            opts.noise_generated = true;
+            if (!get_seed(argv[++i], opts.noise_seed)) {
+                cout << "La semilla del ruido no es un número válido: " << argv[i] << endl;
+                return false;
+            }
+        } else {
+            cout << "Opción desconocida: " << argv[i] << endl;
+            return false;
+        }
+    }
+
+    //El modo de baja memoria no conserva I_M.bmp completa ni copias adicionales de la imagen
+    if ((opts.low_mem_budget > 0) && (opts.bit_planes || (opts.frames > 0))) {
+        cout << "--low-mem no se puede combinar con --bit-planes ni con --frames" << endl;
+        return false;
+    }
+
+    //Sin checkpoints en baja memoria no hay nada que reanudar
+    if ((opts.low_mem_budget > 0) && opts.resume) {
+        cout << "--low-mem no guarda checkpoints; no se puede combinar con --resume" << endl;
+        return false;
+    }
+
+    //La búsqueda en haz trabaja sobre la imagen base completa y no guarda checkpoints
+    if ((opts.beam_width > 0) && (opts.resume || opts.bit_planes || (opts.low_mem_budget > 0))) {
+        cout << "--beam no se puede combinar con --resume, --bit-planes ni --low-mem" << endl;
+        return false;
+    }
+
+    return true;
+}
+
 int main(int argc, char* argv[])
 {
+    //Primera instrucción: el tiempo de arranque de --perf se mide desde aquí
+    startup_mark_main();
 
-    if (argc != 2) {
-        cout << "Uso reto_1 [num_ops]" << endl;
+    if (argc < 2) {
+        cout << "Uso reto_1 [num_ops] [--resume] [--bit-planes] [--frames N] [--no-huge-pages] [--perf] [--low-mem MiB] [--beam K]"
+                " [--noise-seed S]" << endl;
+        cout << "    K: ancho del haz, entre 1 y " << MAX_BEAM_WIDTH << endl;
+        cout << "    reto_1 --verify [referencia.bmp] [--noise-seed S]" << endl;
         return EXIT_FAILURE;
     }
 
+    if (strcmp(argv[1], "--verify") == 0) {
+        const char *reference_path = nullptr;
+        bool noise_generated = false;
+        uint64_t noise_seed = 0;
+
+        for (int i = 2; i < argc; i++) {
+            if ((strcmp(argv[i], "--noise-seed") == 0) && (i + 1 < argc)) {
+                noise_generated = true;
+                if (!get_seed(argv[++i], noise_seed)) {
+                    cout << "La semilla del ruido no es un número válido: " << argv[i] << endl;
+                    return EXIT_FAILURE;
+                }
+            } else if ((reference_path == nullptr) && (argv[i][0] != '-')) {
+                reference_path = argv[i];
+            } else {
+                cout << "Uso reto_1 --verify [referencia.bmp] [--noise-seed S]" << endl;
+                return EXIT_FAILURE;
+            }
+        }
+        return verify_chain(reference_path, noise_generated, noise_seed) ? 0 : EXIT_FAILURE;
+    }
+
     int8_t num_ops;
+    app_options opts;
+
+    if (!parse_options(argc, argv, opts))
+        return EXIT_FAILURE;
 
     if (!get_int8_t(argv[1], num_ops)) {
         cout << "No ingresó un número válido. Vuelva a intentarlo" << endl;
@@ -88,9 +259,7 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    app_img(num_ops);
-
-    return 0;
+    return app_img(num_ops, opts) ? 0 : EXIT_FAILURE;
 }
 
 
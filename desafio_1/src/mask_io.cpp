@@ -0,0 +1,255 @@
+#include <stdint.h>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "include/mask_io.hpp"
+
+using namespace std;
+
+#define SIMD_BLOCK 16
+#define MAX_VALUE_DIGITS 10
+
+/// Estado del análisis de un archivo de enmascaramiento, compartido entre bloques
+struct mask_parser {
+    const uint8_t *mask_data;       ///< Píxeles de la máscara `M.bmp`
+    uint8_t *reversed_mask;         ///< Destino de ID(k+s) = s(k) - M(k)
+    uint32_t mask_size;             ///< Número de bytes esperados después de la semilla
+    uint32_t img_size;              ///< Bytes de la imagen; la ventana [semilla, semilla + mask_size) debe caber
+    uint32_t n_values;              ///< Valores leídos, incluida la semilla
+    uint64_t value;                 ///< Número en curso (puede continuar en el siguiente bloque)
+    uint32_t n_digits;              ///< Dígitos del número en curso
+    bool in_number;                 ///< true si el último byte analizado era un dígito
+    uint32_t seed;                  ///< Semilla (primer número del archivo)
+    const char *error;              ///< Motivo del rechazo, si no es un problema de formato
+};
+
+static bool emit_value(mask_parser &mp);
+static bool push_digit(mask_parser &mp, const uint8_t digit);
+static bool push_digit(mask_parser &mp, const uint8_t digit)
+{
+    /**
+     * @brief Agrega un dígito al número en curso.
+     *
+     * @return false si el número supera `MAX_VALUE_DIGITS` dígitos; con ese límite el valor cabe en 64 bits.
+     */
+    if (++mp.n_digits > MAX_VALUE_DIGITS) {
+        mp.error = "el número tiene demasiados dígitos";
+        return false;
+    }
+
+    mp.value = mp.value*10 + digit;
+    mp.in_number = true;
+    return true;
+}
+
+static bool parse_scalar(mask_parser &mp, const uint8_t *text, const size_t size);
+static bool is_space(const uint8_t c);
+#ifdef __SSE2__
+static bool parse_block(mask_parser &mp, const uint8_t *block);
+#endif
+
+bool read_reversed_mask(const char *path, const uint8_t *mask_data, const uint32_t mask_size,
+                        const uint32_t img_size, uint32_t &seed, uint8_t *reversed_mask)
+{
+    /**
+     * @brief Lee un archivo de enmascaramiento y lo desenmascara en la misma pasada.
+     *
+     * Cada número s(k) se convierte en ID(k+s) = s(k) - M(k) (módulo 256) en cuanto termina de leerse, directamente
+     * sobre `reversed_mask`: no hay arreglo intermedio de valores ni una segunda pasada para restar la máscara.
+     * El archivo se mapea en memoria y, con SSE2, se clasifican 16 caracteres a la vez (dígito o separador); los
+     * dígitos de cada número se acumulan recorriendo los bits de esa clasificación. Sin SSE2 se usa la misma
+     * lógica carácter por carácter.
+     *
+     * Se rechazan números de más de 10 dígitos, una semilla cuya ventana se sale de la imagen y valores s(k) que
+     * no pueden venir de un canal: s(k) = ID(k+s) + M(k), así que s(k) - M(k) debe estar entre 0 y 255.
+     *
+     * @param path Ruta del archivo que contiene la semilla y los datos de enmascaramiento.
+     * @param mask_data Píxeles de la máscara `M.bmp`.
+     * @param mask_size Número de bytes de la máscara; el archivo debe tener exactamente esa cantidad de valores.
+     * @param img_size Número de bytes de la imagen; la semilla más `mask_size` no puede superarlo.
+     * @param seed Parámetro de salida con la semilla leída.
+     * @param reversed_mask Buffer de `mask_size` bytes donde se escribe la máscara revertida.
+     * @return true si el archivo se leyó y es consistente con la máscara; false en caso contrario.
+     */
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        cout << "No se pudo abrir el archivo " << path << endl;
+        return false;
+    }
+
+    struct stat st;
+
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+        cout << "El archivo " << path << " está vacío" << endl;
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        cout << "No se pudo leer el archivo " << path << endl;
+        return false;
+    }
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    const uint8_t *text = static_cast<const uint8_t *>(map);
+    size_t size = st.st_size;
+    size_t pos = 0;
+    mask_parser mp = {mask_data, reversed_mask, mask_size, img_size, 0, 0, 0, false, 0, nullptr};
+    bool ok = true;
+
+#ifdef __SSE2__
+    for (; ok && (pos + SIMD_BLOCK <= size); pos += SIMD_BLOCK)
+        ok = parse_block(mp, text + pos);
+#endif
+
+    if (ok)
+        ok = parse_scalar(mp, text + pos, size - pos);
+
+    //Un número al final del archivo sin separador posterior
+    if (ok && mp.in_number)
+        ok = emit_value(mp);
+
+    munmap(map, size);
+
+    if (!ok && (mp.error != nullptr)) {
+        cout << "El archivo " << path << " tiene un valor inválido: " << mp.error << endl;
+        return false;
+    }
+
+    if (!ok) {
+        cout << "El archivo " << path << " tiene un formato inválido" << endl;
+        return false;
+    }
+
+    if (mp.n_values != mask_size + 1) {
+        cout << "La imagen máscara y el archivo de máscara son inconsistentes" << endl;
+        return false;
+    }
+
+    seed = mp.seed;
+    return true;
+}
+
+static bool emit_value(mask_parser &mp)
+{
+    /**
+     * @brief Guarda el número recién leído: el primero es la semilla y el resto se desenmascaran.
+     *
+     * @return false si el archivo tiene más valores que la máscara, si la ventana de la semilla se sale de la imagen
+     * o si el valor no corresponde a un canal enmascarado.
+     */
+    if (mp.n_values == 0) {
+        if (mp.value + mp.mask_size > mp.img_size) {
+            mp.error = "la semilla se sale de la imagen";
+            return false;
+        }
+        mp.seed = mp.value;
+    } else {
+        uint32_t k = mp.n_values - 1;
+
+        if (k >= mp.mask_size)
+            return false;
+
+        if ((mp.value < mp.mask_data[k]) || (mp.value - mp.mask_data[k] > UINT8_MAX)) {
+            mp.error = "el canal desenmascarado no está entre 0 y 255";
+            return false;
+        }
+        mp.reversed_mask[k] = mp.value - mp.mask_data[k];
+    }
+
+    mp.n_values++;
+    mp.value = 0;
+    mp.n_digits = 0;
+    mp.in_number = false;
+    return true;
+}
+
+static bool parse_scalar(mask_parser &mp, const uint8_t *text, const size_t size)
+{
+    /**
+     * @brief Analiza `size` caracteres uno por uno; se usa para el final del archivo y cuando no hay SSE2.
+     *
+     * @return false si aparece un carácter que no es dígito ni espacio, o si sobran valores.
+     */
+    for (size_t i = 0; i < size; i++) {
+        uint8_t digit = text[i] - '0';
+
+        if (digit <= 9) {
+            if (!push_digit(mp, digit))
+                return false;
+        } else if (!is_space(text[i])) {
+            return false;
+        } else if (mp.in_number && !emit_value(mp)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool is_space(const uint8_t c)
+{
+    /**
+     * @brief Separadores aceptados entre números (el archivo puede tener finales de línea de Windows).
+     */
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+#ifdef __SSE2__
+static bool parse_block(mask_parser &mp, const uint8_t *block)
+{
+    /**
+     * @brief Analiza 16 caracteres clasificándolos con SSE2.
+     *
+     * Se obtiene una máscara de bits con los dígitos del bloque y se valida que el resto sean separadores. Cada
+     * racha de bits en 1 es un número (o la continuación del que venía del bloque anterior); si la racha llega al
+     * final del bloque el número queda abierto en `mp`.
+     *
+     * @return false si aparece un carácter que no es dígito ni espacio, o si sobran valores.
+     */
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+    __m128i is_sep = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+                                               _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'))),
+                                  _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\r')),
+                                               _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))));
+    uint32_t digits = _mm_movemask_epi8(is_digit);
+
+    if ((digits | (uint32_t)_mm_movemask_epi8(is_sep)) != 0xFFFF)
+        return false;
+
+    //El número del bloque anterior terminó justo antes de este bloque
+    if (mp.in_number && !(digits & 1) && !emit_value(mp))
+        return false;
+
+    while (digits) {
+        uint32_t start = __builtin_ctz(digits);
+        uint32_t len = __builtin_ctz(~(digits >> start));
+
+        for (uint32_t j = start; j < start + len; j++)
+            if (!push_digit(mp, block[j] - '0'))
+                return false;
+
+        if (start + len == SIMD_BLOCK)
+            break;
+
+        if (!emit_value(mp))
+            return false;
+
+        digits &= ~(((1u << len) - 1) << start);
+    }
+
+    return true;
+}
+#endif
@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <cstring>
+#include <iostream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "include/noise_source.hpp"
+#include "include/image_io.hpp"
+#include "include/img_alloc.hpp"
+#include "include/constants.hpp"
+
+using namespace std;
+
+//Constantes de Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+#define PHILOX_BLOCK 16
+
+static void fill_loaded(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out);
+static void fill_file(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out);
+static void fill_generated(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out);
+static void philox_block(const uint64_t counter, const uint64_t key, uint8_t *out);
+#ifdef __SSE2__
+static void philox_blocks_sse2(const uint64_t counter, const uint64_t key, uint8_t *out);
+#endif
+
+bool noise_source_load(noise_source &ns, const char *path)
+{
+    /**
+     * @brief Fuente respaldada por un archivo que se carga completo en memoria (comportamiento original).
+     *
+     * @param ns Fuente a inicializar.
+     * @param path Ruta de la imagen de ruido.
+     * @return true si la imagen se pudo cargar.
+     */
+    ns = {};
+    ns.owned = loadPixels(path, ns.width, ns.height);
+    ns.data = ns.owned;
+    ns.fill = fill_loaded;
+
+    return ns.data != nullptr;
+}
+
+bool noise_source_open(noise_source &ns, const char *path)
+{
+    /**
+     * @brief Fuente respaldada por un archivo que no se carga: cada rango pedido se lee con `pread`.
+     *
+     * El archivo no se mapea, así que sus páginas quedan en la caché del kernel y no en la memoria residente.
+     *
+     * @param ns Fuente a inicializar.
+     * @param path Ruta de la imagen de ruido (BMP sin compresión).
+     * @return true si el archivo se pudo abrir.
+     */
+    ns = {};
+    ns.fill = fill_file;
+    ns.file.fd = -1;
+
+    if (!bmp_file_open(path, ns.file))
+        return false;
+
+    ns.width = ns.file.width;
+    ns.height = ns.file.height;
+    return true;
+}
+
+void noise_source_generate(noise_source &ns, const uint64_t key, const uint16_t width, const uint16_t height)
+{
+    /**
+     * @brief Fuente generada con Philox4x32-10: el byte i de la imagen es el byte i % 16 del bloque i / 16.
+     *
+     * Al ser un generador basado en contador, cualquier rango se obtiene sin generar los bytes anteriores, así que
+     * no hace falta guardar la imagen de ruido en disco ni en memoria.
+     *
+     * @param ns Fuente a inicializar.
+     * @param key Semilla del generador.
+     * @param width Ancho de la imagen de ruido.
+     * @param height Alto de la imagen de ruido.
+     */
+    ns = {};
+    ns.fill = fill_generated;
+    ns.key = key;
+    ns.width = width;
+    ns.height = height;
+}
+
+bool noise_source_materialize(noise_source &ns)
+{
+    /**
+     * @brief Deja la imagen de ruido completa en memoria, para los modos que la recorren entera varias veces
+     * (planos de bits, secuencias de cuadros). No hace nada si ya lo está.
+     *
+     * @param ns Fuente a materializar.
+     * @return true si `ns.data` quedó disponible.
+     */
+    if (ns.data != nullptr)
+        return true;
+
+    uint32_t size = ns.width*ns.height*RGB_CHANNELS;
+    uint8_t *buffer = static_cast<uint8_t *>(img_alloc(size));
+
+    if (buffer == nullptr)
+        return false;
+
+    ns.fill(ns, 0, size, buffer);
+    img_free(ns.owned);
+    ns.owned = buffer;
+    ns.data = buffer;
+    return true;
+}
+
+const uint8_t *noise_source_window(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *buffer)
+{
+    /**
+     * @brief Devuelve los bytes [offset, offset + size) del ruido.
+     *
+     * Si la imagen está en memoria se devuelve un puntero a ella sin copiar; si no, el rango se escribe en `buffer`.
+     *
+     * @param ns Fuente de ruido.
+     * @param offset Primer byte del rango.
+     * @param size Número de bytes.
+     * @param buffer Buffer de al menos `size` bytes, usado solo si la imagen no está en memoria.
+     * @return Puntero a los bytes pedidos.
+     */
+    if (ns.data != nullptr)
+        return ns.data + offset;
+
+    ns.fill(ns, offset, size, buffer);
+    return buffer;
+}
+
+void noise_source_apply_chain(const noise_source &ns, const fused_chain &fc, uint8_t *img_data, const uint32_t size,
+                              uint8_t *chunk, const uint32_t chunk_size)
+{
+    /**
+     * @brief Aplica una cadena compilada a toda la imagen leyendo el ruido por bloques de `chunk_size` bytes.
+     *
+     * Si la imagen de ruido está en memoria o la cadena no usa ruido, es una sola llamada a `apply_fused_chain`.
+     *
+     * @param ns Fuente de ruido.
+     * @param fc Cadena compilada.
+     * @param img_data Imagen a modificar in-place.
+     * @param size Número de bytes de la imagen.
+     * @param chunk Buffer de `chunk_size` bytes para el ruido.
+     * @param chunk_size Tamaño del bloque de ruido.
+     */
+    if ((ns.data != nullptr) || !fc.uses_noise) {
+        apply_fused_chain(fc, img_data, ns.data, size);
+        return;
+    }
+
+    for (uint32_t offset = 0; offset < size; offset += chunk_size) {
+        uint32_t bytes = (offset + chunk_size > size) ? (size - offset) : chunk_size;
+
+        ns.fill(ns, offset, bytes, chunk);
+        apply_fused_chain(fc, img_data + offset, chunk, bytes);
+    }
+}
+
+void noise_source_close(noise_source &ns)
+{
+    /**
+     * @brief Libera la memoria o cierra el archivo de la fuente.
+     */
+    img_free(ns.owned);
+    if (ns.file.header != nullptr)
+        bmp_file_close(ns.file);
+    ns = {};
+}
+
+void philox_fill(const uint64_t key, const uint64_t offset, const uint32_t size, uint8_t *out)
+{
+    /**
+     * @brief Escribe los bytes [offset, offset + size) del flujo de Philox4x32-10 con la semilla `key`.
+     *
+     * El bloque k del flujo se obtiene cifrando el contador k, así que los bloques son independientes: con SSE2
+     * se generan cuatro bloques a la vez (64 bytes) y los bordes del rango se recortan de un bloque suelto.
+     *
+     * @param key Semilla del generador.
+     * @param offset Primer byte del flujo.
+     * @param size Número de bytes.
+     * @param out Buffer de salida de `size` bytes.
+     */
+    uint8_t block[PHILOX_BLOCK];
+    uint64_t counter = offset / PHILOX_BLOCK;
+    uint32_t skip = offset % PHILOX_BLOCK;
+    uint32_t done = 0;
+
+    //Bloque inicial parcial
+    if ((skip != 0) && (size > 0)) {
+        uint32_t take = (PHILOX_BLOCK - skip < size) ? (PHILOX_BLOCK - skip) : size;
+
+        philox_block(counter++, key, block);
+        memcpy(out, block + skip, take);
+        done = take;
+    }
+
+#ifdef __SSE2__
+    for (; done + 4*PHILOX_BLOCK <= size; done += 4*PHILOX_BLOCK, counter += 4)
+        philox_blocks_sse2(counter, key, out + done);
+#endif
+
+    for (; done + PHILOX_BLOCK <= size; done += PHILOX_BLOCK)
+        philox_block(counter++, key, out + done);
+
+    //Bloque final parcial
+    if (done < size) {
+        philox_block(counter, key, block);
+        memcpy(out + done, block, size - done);
+    }
+}
+
+static void fill_loaded(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out)
+{
+    memcpy(out, ns.data + offset, size);
+}
+
+static void fill_file(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out)
+{
+    //Una lectura fallida deja el rango en cero; el resultado no coincidirá con M.txt y la etapa lo detecta
+    if (!bmp_file_read_rgb(ns.file, offset, size, out))
+        cout << "Error: No se pudo leer la imagen de entropía" << endl;
+}
+
+static void fill_generated(const noise_source &ns, const uint32_t offset, const uint32_t size, uint8_t *out)
+{
+    philox_fill(ns.key, offset, size, out);
+}
+
+static void philox_block(const uint64_t counter, const uint64_t key, uint8_t *out)
+{
+    /**
+     * @brief Un bloque de Philox4x32-10 con contador (counter, 0) y clave `key`, en bytes little-endian.
+     */
+    uint32_t c[4] = {(uint32_t)counter, (uint32_t)(counter >> 32), 0, 0};
+    uint32_t k0 = (uint32_t)key;
+    uint32_t k1 = (uint32_t)(key >> 32);
+
+    for (uint8_t r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c[0];
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c[2];
+        uint32_t next[4] = {(uint32_t)(p1 >> 32) ^ c[1] ^ k0, (uint32_t)p1, (uint32_t)(p0 >> 32) ^ c[3] ^ k1, (uint32_t)p0};
+
+        memcpy(c, next, sizeof(c));
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    for (uint8_t w = 0; w < 4; w++)
+        for (uint8_t b = 0; b < 4; b++)
+            out[4*w + b] = c[w] >> (8*b);
+}
+
+#ifdef __SSE2__
+static void philox_blocks_sse2(const uint64_t counter, const uint64_t key, uint8_t *out)
+{
+    /**
+     * @brief Cuatro bloques consecutivos de Philox4x32-10: cada registro guarda la misma palabra de los cuatro
+     * contadores y los productos de 32x32 bits se obtienen con `_mm_mul_epu32` sobre los carriles pares e impares.
+     */
+    const __m128i low_mask = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i m0 = _mm_set1_epi32(PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32(PHILOX_M1);
+    __m128i c0 = _mm_set_epi32((uint32_t)(counter + 3), (uint32_t)(counter + 2), (uint32_t)(counter + 1), (uint32_t)counter);
+    __m128i c1 = _mm_set_epi32((uint32_t)((counter + 3) >> 32), (uint32_t)((counter + 2) >> 32),
+                               (uint32_t)((counter + 1) >> 32), (uint32_t)(counter >> 32));
+    __m128i c2 = _mm_setzero_si128();
+    __m128i c3 = _mm_setzero_si128();
+    uint32_t k0 = (uint32_t)key;
+    uint32_t k1 = (uint32_t)(key >> 32);
+
+    for (uint8_t r = 0; r < PHILOX_ROUNDS; r++) {
+        __m128i even0 = _mm_mul_epu32(c0, m0);
+        __m128i odd0 = _mm_mul_epu32(_mm_srli_epi64(c0, 32), m0);
+        __m128i even1 = _mm_mul_epu32(c2, m1);
+        __m128i odd1 = _mm_mul_epu32(_mm_srli_epi64(c2, 32), m1);
+        __m128i lo0 = _mm_or_si128(_mm_and_si128(even0, low_mask), _mm_slli_epi64(odd0, 32));
+        __m128i hi0 = _mm_or_si128(_mm_srli_epi64(even0, 32), _mm_andnot_si128(low_mask, odd0));
+        __m128i lo1 = _mm_or_si128(_mm_and_si128(even1, low_mask), _mm_slli_epi64(odd1, 32));
+        __m128i hi1 = _mm_or_si128(_mm_srli_epi64(even1, 32), _mm_andnot_si128(low_mask, odd1));
+
+        c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(k0));
+        c1 = lo1;
+        c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(k1));
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    //Transposición 4x4: de una palabra por registro a un bloque por registro
+    __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+    __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+    __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+    __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + PHILOX_BLOCK), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2*PHILOX_BLOCK), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 3*PHILOX_BLOCK), _mm_unpackhi_epi64(t2, t3));
+}
+#endif
@@ -0,0 +1,192 @@
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "include/perf_counters.hpp"
+
+using namespace std;
+
+#define DTLB_ACCESS 0
+#define DTLB_MISS 1
+#define NODE_ACCESS 2
+#define NODE_MISS 3
+#define STAT_LINE_SIZE 1024
+#define STAT_STARTTIME_FIELD 22
+
+/// Instante de entrada a `main` (CLOCK_MONOTONIC); cero hasta que se llama a `startup_mark_main`
+static struct timespec main_start = {0, 0};
+
+static int open_cache_event(const uint32_t cache, const uint32_t result);
+static double rate(const uint64_t part, const uint64_t total);
+
+bool perf_counters_start(perf_counters &pc)
+{
+    /**
+     * @brief Abre y activa los contadores de lecturas y fallos de la dTLB y de accesos a memoria por nodo NUMA.
+     *
+     * Los fallos del contador de nodo corresponden a lecturas servidas por la memoria de otro socket, es decir,
+     * accesos remotos. Los contadores que el kernel o la CPU no soporten quedan deshabilitados sin abortar.
+     *
+     * @param pc Contadores a inicializar.
+     * @return true si se pudo abrir al menos un contador; false si perf_event_open no está disponible.
+     */
+    pc.fd[DTLB_ACCESS] = open_cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_ACCESS);
+    pc.fd[DTLB_MISS] = open_cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS);
+    pc.fd[NODE_ACCESS] = open_cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_RESULT_ACCESS);
+    pc.fd[NODE_MISS] = open_cache_event(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_RESULT_MISS);
+
+    bool any = false;
+
+    for (uint8_t i = 0; i < PERF_EVENTS; i++) {
+        if (pc.fd[i] < 0)
+            continue;
+        ioctl(pc.fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc.fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        any = true;
+    }
+
+    if (!any)
+        cout << "No se pudieron abrir los contadores de rendimiento (revise /proc/sys/kernel/perf_event_paranoid)" << endl;
+
+    return any;
+}
+
+void perf_counters_report(perf_counters &pc, const char *label)
+{
+    /**
+     * @brief Detiene los contadores, imprime las tasas de fallos de TLB y de accesos remotos y los cierra.
+     *
+     * @param pc Contadores abiertos con `perf_counters_start`.
+     * @param label Texto que identifica la sección medida.
+     */
+    uint64_t values[PERF_EVENTS] = {0};
+
+    for (uint8_t i = 0; i < PERF_EVENTS; i++) {
+        if (pc.fd[i] < 0)
+            continue;
+        ioctl(pc.fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(pc.fd[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+            values[i] = 0;
+        close(pc.fd[i]);
+        pc.fd[i] = -1;
+    }
+
+    cout << label << ": dTLB " << values[DTLB_MISS] << " fallos / " << values[DTLB_ACCESS] << " lecturas ("
+         << rate(values[DTLB_MISS], values[DTLB_ACCESS]) << " %), nodo remoto " << values[NODE_MISS] << " / "
+         << values[NODE_ACCESS] << " (" << rate(values[NODE_MISS], values[NODE_ACCESS]) << " %)" << endl;
+}
+
+void startup_mark_main(void)
+{
+    /**
+     * @brief Guarda el instante de entrada a `main` con CLOCK_MONOTONIC; debe ser lo primero que ejecuta `main`.
+     */
+    clock_gettime(CLOCK_MONOTONIC, &main_start);
+}
+
+double startup_main_ms(void)
+{
+    /**
+     * @brief Tiempo transcurrido desde `startup_mark_main` hasta ahora, en milisegundos.
+     *
+     * Mide la lectura de la imagen, del ruido y de la máscara hasta la primera etapa con la resolución de
+     * CLOCK_MONOTONIC (nanosegundos), sin depender de los ticks de /proc.
+     *
+     * @return Latencia en milisegundos, o -1 si `startup_mark_main` no se llamó.
+     */
+    if ((main_start.tv_sec == 0) && (main_start.tv_nsec == 0))
+        return -1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - main_start.tv_sec)*1000.0 + (now.tv_nsec - main_start.tv_nsec) / 1e6;
+}
+
+double startup_premain_ms(double &resolution_ms)
+{
+    /**
+     * @brief Tiempo aproximado desde que el kernel creó el proceso hasta la entrada a `main`, en milisegundos.
+     *
+     * Incluye la carga y reubicación de las bibliotecas dinámicas (Qt en el front end), que ocurren antes de
+     * `main` y no se pueden medir con un reloj propio. El inicio se toma del campo `starttime` de /proc/self/stat,
+     * que el kernel guarda en ticks de reloj, así que el resultado se redondea a ticks: por debajo de esa
+     * resolución la comparación entre binarios se hace midiendo muchas ejecuciones desde fuera.
+     *
+     * @param resolution_ms Parámetro de salida con la duración de un tick en milisegundos (normalmente 10 ms).
+     * @return Latencia en milisegundos, múltiplo de `resolution_ms`, o -1 si /proc no está disponible.
+     */
+    char line[STAT_LINE_SIZE];
+    FILE *file = fopen("/proc/self/stat", "r");
+
+    resolution_ms = 1000.0 / sysconf(_SC_CLK_TCK);
+
+    if ((file == nullptr) || (startup_main_ms() < 0)) {
+        if (file != nullptr)
+            fclose(file);
+        return -1;
+    }
+
+    bool ok = fgets(line, sizeof(line), file) != nullptr;
+    fclose(file);
+
+    //El nombre del proceso (campo 2) puede tener espacios, así que los campos se cuentan desde el último ')'
+    char *field = ok ? strrchr(line, ')') : nullptr;
+    unsigned long long start_ticks = 0;
+
+    if (field == nullptr)
+        return -1;
+
+    for (uint8_t i = 2; (field != nullptr) && (i < STAT_STARTTIME_FIELD); i++)
+        field = strchr(field + 1, ' ');
+
+    if ((field == nullptr) || (sscanf(field, "%llu", &start_ticks) != 1))
+        return -1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+
+    double age_ms = (now.tv_sec + now.tv_nsec / 1e9) * 1000.0 - start_ticks*resolution_ms;
+    double premain_ms = age_ms - startup_main_ms();
+
+    if (premain_ms < 0)
+        premain_ms = 0;
+
+    return (uint64_t)(premain_ms / resolution_ms + 0.5) * resolution_ms;
+}
+
+static int open_cache_event(const uint32_t cache, const uint32_t result)
+{
+    /**
+     * @brief Abre un contador de caché de lectura para el proceso actual en cualquier CPU.
+     *
+     * @param cache Caché a medir (PERF_COUNT_HW_CACHE_DTLB o PERF_COUNT_HW_CACHE_NODE).
+     * @param result Accesos o fallos (PERF_COUNT_HW_CACHE_RESULT_ACCESS o PERF_COUNT_HW_CACHE_RESULT_MISS).
+     * @return Descriptor del contador, o -1 si no está disponible.
+     */
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static double rate(const uint64_t part, const uint64_t total)
+{
+    /**
+     * @brief Porcentaje de `part` sobre `total`, o 0 si no hubo eventos.
+     */
+    return total ? (100.0 * part) / total : 0.0;
+}
@@ -1,24 +1,81 @@
 #include <stdint.h>
-#include <fstream>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <QCoreApplication>
-#include <QImage>
+#include <algorithm>
+#include <unistd.h>
 #include "include/process_data.hpp"
+#include "include/image_io.hpp"
 #include "include/bitwise_pixel.hpp"
 #include "include/constants.hpp"
+#include "include/checkpoint.hpp"
+#include "include/bit_planes.hpp"
+#include "include/frames.hpp"
+#include "include/img_alloc.hpp"
+#include "include/perf_counters.hpp"
+#include "include/bmp_io.hpp"
+#include "include/mask_io.hpp"
+#include "include/noise_source.hpp"
+#include "include/verify.hpp"
 
 using namespace std;
 
-static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t *img_noisy, const uint8_t *reversed_mask,
-                                    const uint32_t seed, const uint32_t num_pixels, uint8_t &op_code);
-static uint8_t *get_reversed_mask(const char *path_masking_data, const uint8_t *mask_data, uint32_t &seed, uint32_t &n_pixels);
-static uint8_t *reverse_mask(const uint32_t *bytes_masked, const uint8_t *mask, const uint32_t size);
+#define STATUS_LINE_SIZE 256
+#define LOST_BIT_WEIGHT 4     ///< Un bit perdido por byte pesa 1/LOST_BIT_WEIGHT de un bit distinto
+
+/// Calcula la distancia de Hamming del candidato (op_code, n) en la etapa descrita por `ctx`
+typedef uint32_t (*stage_score)(const void *ctx, const uint8_t op_code, const uint8_t n);
+
+/// Datos de una etapa cuando la imagen se guarda como bytes RGB888
+struct byte_stage {
+    const uint8_t *img_data;
+    const uint8_t *img_noisy;
+    const uint8_t *reversed_mask;
+    uint32_t seed;
+    uint32_t num_pixels;
+};
+
+/// Imagen, ruido y ventanas de la etapa actual cuando se usa la representación en planos de bits
+struct planes_engine {
+    bit_planes img;
+    bit_planes noisy;
+    bit_planes reversed_mask;
+    bit_planes img_window;
+    bit_planes noisy_window;
+};
+
+/// Hipótesis de la búsqueda en haz: la cadena invertida hasta ahora, compuesta sobre la imagen base compartida
+struct beam_hypothesis {
+    fused_chain fc;                 ///< Imagen actual = img_lut[I_D] ^ noisy_lut[I_M]
+    uint64_t score;                 ///< Distancia de Hamming acumulada en los bits conocidos más la penalización por bits perdidos
+    stage_op ops[INT8_MAX];         ///< Operación elegida en cada etapa (`ops[i-1]` es la etapa `i`)
+};
+
+static uint8_t apply_ops(const int8_t op, stage_score score, const void *ctx, uint8_t &op_code);
+static bool beam_search_ops(const uint8_t n, const uint32_t beam_width, uint8_t *img_data, const noise_source &noise,
+                            const uint8_t *mask_data, uint8_t *reversed_mask, const uint32_t img_size,
+                            const uint32_t mask_size, stage_op *ops);
+static uint32_t score_window(const fused_chain &step, const uint8_t *window, const uint8_t *noisy,
+                             const uint8_t *reversed_mask, const uint32_t mask_size, const uint8_t known);
+static uint64_t replay_distance(const beam_hypothesis &hyp, const uint8_t n, const uint8_t *img_data,
+                                const noise_source &noise, const uint32_t img_size, uint8_t *noisy_chunk,
+                                const uint64_t limit);
+static void print_stage_op(const uint8_t stage, const stage_op &op);
+static uint32_t score_bytes(const void *ctx, const uint8_t op_code, const uint8_t n);
+static uint32_t score_planes(const void *ctx, const uint8_t op_code, const uint8_t n);
+static bool planes_engine_init(planes_engine &pe, const uint8_t *img_data, const uint8_t *img_noisy_data,
+                               const uint32_t img_size, const uint32_t mask_size);
+static void planes_engine_free(planes_engine &pe);
+static void reverse_operations_planes(planes_engine &pe, const uint8_t op, const uint8_t n);
+static uint8_t *load_image(const char *path, uint16_t &width, uint16_t &height, const bool low_mem);
+static uint64_t status_kib(const char *field);
+static void reverse_xor_streamed(uint8_t *img_data, const noise_source &noise, uint8_t *noisy_chunk,
+                                 const uint32_t chunk_size, const uint32_t img_size);
 static void reverse_operations(uint8_t *img_data, const uint8_t *img_noisy_data,
                                const uint16_t width, const uint16_t hight, const uint8_t op, const uint8_t n);
-static uint8_t validate_ro_sh(uint8_t (*op)(uint8_t, uint8_t), const uint8_t *img_data,
-                              const uint8_t *reversed_mask, const uint32_t seed, const uint32_t num_pixels,
-                              uint8_t &op_code, uint32_t &max_op_sim, uint8_t curr_op_code, uint8_t curr_n_bits);
-void app_img(uint8_t n)
+static uint8_t validate_ro_sh(stage_score score, const void *ctx, uint8_t &op_code, uint32_t &max_op_sim,
+                              uint8_t curr_op_code, uint8_t curr_n_bits);
+bool app_img(uint8_t n, const app_options &opts)
 {
     /**
      * @brief Aplica un proceso de desenmascaramiento y reversión de transformaciones bit a bit sobre una imagen codificada.
@@ -34,9 +91,41 @@ void app_img(uint8_t n)
      *
      * Finalmente, se exporta la imagen restaurada como `I_O.bmp`.
      *
+     * Cada `CHECKPOINT_INTERVAL` etapas se guarda de forma asíncrona un checkpoint con la imagen y las operaciones
+     * detectadas. Con `opts.resume` la reversión continúa desde el último checkpoint consistente en lugar de la etapa `n`;
+     * si no hay checkpoint se empieza desde la etapa `n`, y si se guardó con otra `I_D.bmp` u otro ruido se rechaza.
+     *
+     * Con `opts.bit_planes` la imagen y el ruido se transponen a planos de bits: las rotaciones y desplazamientos inversos
+     * se reducen a reetiquetar planos y la similitud de cada candidato se calcula con popcount sobre los planos de la ventana.
+     *
+     * Con `opts.frames` mayor que cero, la cadena detectada se aplica además a los cuadros `I_D0.bmp`, `I_D1.bmp`, ...
+     * usando `process_frames`, sin repetir la detección.
+     *
+     * Los buffers de imágenes y máscaras se reservan con `img_alloc` (páginas grandes salvo `opts.huge_pages` en false).
+     * Con `opts.perf` se imprimen las tasas de fallos de TLB y de accesos a memoria remota durante la reversión.
+     *
+     * Con `opts.low_mem_budget` (MiB) se activa el modo de baja memoria: las imágenes BMP se leen con `pread` sin
+     * copias intermedias de QImage ni mapeos del archivo, de `I_M.bmp` solo se leen ventanas y bloques de filas sobre
+     * buffers fijos, y cada archivo de enmascaramiento se desenmascara mientras se lee, sobre un único buffer de bytes.
+     * Lo residente es entonces la imagen más las ventanas de la máscara y un bloque de a lo sumo `LOAD_CHUNK_ROWS`
+     * filas de `I_M.bmp`. `I_O.bmp` se escribe directamente con `bmp_write`. No se guardan checkpoints en este modo.
+     * Si el presupuesto no alcanza para la imagen más las ventanas, la función falla sin procesar nada; al final se
+     * compara el pico de memoria residente por encima del que tenía el proceso al empezar contra el presupuesto, y
+     * si lo supera también falla.
+     *
+     * Con `opts.beam_width` mayor que cero, la cadena se elige con `beam_search_ops` en lugar de la selección voraz
+     * de `apply_ops`.
+     *
+     * La imagen de ruido se obtiene de un `noise_source`: `I_M.bmp` cargada completa, `I_M.bmp` leída por rangos
+     * (baja memoria) o generada con Philox4x32-10 a partir de `opts.noise_seed`, sin archivo. Si no está completa en
+     * memoria, cada etapa lee solo la ventana de la máscara y los XOR se revierten leyendo el ruido por bloques.
+     *
      * @param n Número de transformaciones (y archivos Mx.txt) a revertir. Se asume que las transformaciones fueron aplicadas en orden.
+     * @param opts Opciones de ejecución leídas desde la línea de comandos.
+     * @return true si la imagen se reconstruyó y se guardó como `I_O.bmp` (y, con `opts.frames`, si todos los cuadros
+     * se restauraron), false en caso contrario.
      *
-     * @note Esta función depende de otras funciones auxiliares como `loadPixels`, `get_reversed_mask`, `aplicar_operaciones`,
+     * @note Esta función depende de otras funciones auxiliares como `loadPixels`, `read_reversed_mask`, `aplicar_operaciones`,
      * `reverse_operations` y `exportImage`. También se apoya en las constantes globales como `RGB_CHANNELS` y `MAX_SIMILARITY`.
      *
      * @warning Si algún archivo no puede abrirse o si las dimensiones de las imágenes son inconsistentes,
@@ -47,80 +136,377 @@ void app_img(uint8_t n)
     uint16_t img_height = 0;
     uint16_t mask_width = 0;
     uint16_t mask_height = 0;
-    uint16_t img_noisy_width = 0;
-    uint16_t img_noisy_height = 0;
     uint8_t op_code = 0;
     uint8_t op_n = 0;
+    uint8_t start_stage = n;
     bool ok_img = true;
+    bool low_mem = opts.low_mem_budget > 0;
+    //Memoria residente del proceso antes de reservar nada, para medir el presupuesto de baja memoria
+    uint64_t baseline_kib = low_mem ? status_kib("VmRSS:") : 0;
+    noise_source noise = {};
+
+    //Las páginas grandes inflan la memoria residente, así que no se usan con presupuesto de memoria
+    img_alloc_set_huge_pages(opts.huge_pages && !low_mem);
 
-    uint8_t *mask_data = loadPixels("M.bmp", mask_width, mask_height);
+    uint8_t *mask_data = load_image("M.bmp", mask_width, mask_height, low_mem);
 
     if (mask_data == nullptr) {
         cout << "No se pudo leer el archivo de máscara M.bmp" << endl;
-        return;
+        return false;
     }
 
-    uint8_t *img_noisy_data = loadPixels("I_M.bmp", img_noisy_width, img_noisy_height);
-
-    if (img_noisy_data == nullptr) {
+    //El ruido generado no necesita archivo; sus dimensiones se toman de I_D.bmp
+    if (!opts.noise_generated && !(low_mem ? noise_source_open(noise, "I_M.bmp") : noise_source_load(noise, "I_M.bmp"))) {
         cout << "No se pudo leer la imagen de entropía I_M.bmp" << endl;
-        delete[] mask_data;
-        return;
+        img_free(mask_data);
+        return false;
     }
 
-    uint8_t *img_data = loadPixels("I_D.bmp", img_width, img_height);
+    uint8_t *img_data = load_image("I_D.bmp", img_width, img_height, low_mem);
 
     if (img_data == nullptr) {
         cout << "Error abriendo I_D.bmp" << endl;
-        delete[] mask_data;
-        delete[] img_noisy_data;
-        return;
+        img_free(mask_data);
+        noise_source_close(noise);
+        return false;
     }
 
-    if ((img_width != img_noisy_width) || (img_height != img_noisy_height)) {
+    if (opts.noise_generated)
+        noise_source_generate(noise, opts.noise_seed, img_width, img_height);
+
+    if ((img_width != noise.width) || (img_height != noise.height)) {
         cout << "La imagen objetivo y la imagen de entropía no tienen las mismas dimensiones" << endl;
-        delete[] mask_data;
-        delete[] img_noisy_data;
-        delete[] img_data;
-        return;
+        img_free(mask_data);
+        noise_source_close(noise);
+        img_free(img_data);
+        return false;
+    }
+
+    //Los planos de bits y la secuencia de cuadros recorren el ruido completo varias veces
+    if ((opts.bit_planes || (opts.frames > 0)) && !noise_source_materialize(noise)) {
+        cout << "No hay memoria para la imagen de entropía" << endl;
+        img_free(mask_data);
+        noise_source_close(noise);
+        img_free(img_data);
+        return false;
+    }
+
+    //Todos los hilos de la secuencia de cuadros leen el ruido: si es un mapeo propio se reparte entre nodos NUMA
+    if (opts.frames > 0)
+        img_alloc_interleave(noise.owned);
+
+    const uint8_t *img_noisy_data = noise.data;
+    uint32_t mask_size = mask_width*mask_height*RGB_CHANNELS;
+    uint32_t img_size = img_width*img_height*RGB_CHANNELS;
+    //Todas las etapas desenmascaran sobre el mismo buffer
+    uint8_t *reversed_mask = static_cast<uint8_t *>(img_alloc(mask_size));
+
+    if (reversed_mask == nullptr) {
+        cout << "No hay memoria para la máscara revertida" << endl;
+        img_free(mask_data);
+        noise_source_close(noise);
+        img_free(img_data);
+        return false;
+    }
+
+    //Si el ruido no está en memoria se lee por rangos: la ventana de la máscara y bloques de filas para el XOR
+    uint32_t row_size = img_width*RGB_CHANNELS;
+    uint32_t chunk_rows = 0;
+    uint8_t *noisy_window = nullptr;
+    uint8_t *noisy_chunk = nullptr;
+
+    if (img_noisy_data == nullptr) {
+        uint64_t budget = (uint64_t)opts.low_mem_budget*1024*1024;
+        //Imagen, máscara, máscara revertida, ventana del ruido y la fila que usa cada lectura con pread
+        uint64_t fixed = (uint64_t)row_size*img_height + 3*mask_size + row_size;
+
+        chunk_rows = (img_height < LOAD_CHUNK_ROWS) ? img_height : LOAD_CHUNK_ROWS;
+
+        if (low_mem && (fixed + row_size > budget)) {
+            //Ni siquiera cabe la imagen con una sola fila de I_M.bmp
+            cout << "El presupuesto de memoria (" << opts.low_mem_budget << " MiB) no alcanza: se necesitan al menos "
+                 << (fixed + row_size + 1024*1024 - 1) / (1024*1024) << " MiB" << endl;
+            img_free(reversed_mask);
+            img_free(mask_data);
+            noise_source_close(noise);
+            img_free(img_data);
+            return false;
+        } else if (low_mem && ((budget - fixed) / row_size < chunk_rows)) {
+            chunk_rows = (budget - fixed) / row_size;
+        }
+
+        noisy_window = static_cast<uint8_t *>(img_alloc(mask_size));
+        noisy_chunk = static_cast<uint8_t *>(img_alloc(chunk_rows*row_size));
+
+        if ((noisy_window == nullptr) || (noisy_chunk == nullptr)) {
+            cout << "No hay memoria para los buffers de la imagen de entropía" << endl;
+            img_free(reversed_mask);
+            img_free(noisy_window);
+            img_free(noisy_chunk);
+            img_free(mask_data);
+            noise_source_close(noise);
+            img_free(img_data);
+            return false;
+        }
+    }
+
+    //Las etapas aún no detectadas quedan en cero para que el checkpoint sea determinista
+    stage_op *ops = new stage_op[n]();
+
+    //La búsqueda en haz y el modo de baja memoria no guardan checkpoints
+    bool checkpoints = !low_mem && (opts.beam_width == 0);
+    checkpoint_inputs inputs = {};
+
+    //La huella se toma de I_D.bmp antes de que un checkpoint la reemplace
+    if (checkpoints)
+        checkpoint_fingerprint(inputs, img_data, img_size, noise, opts.noise_generated);
+
+    if (opts.resume && (access(CHECKPOINT_PATH, F_OK) != 0)) {
+        cout << "No existe un checkpoint en " << CHECKPOINT_PATH << ", se empieza desde la operación #"
+             << (uint32_t)n << endl;
+    } else if (opts.resume) {
+        if (!checkpoint_load(CHECKPOINT_PATH, img_data, ops, img_width, img_height, n, inputs, start_stage)) {
+            delete[] ops;
+            img_free(reversed_mask);
+            img_free(noisy_window);
+            img_free(noisy_chunk);
+            img_free(mask_data);
+            noise_source_close(noise);
+            img_free(img_data);
+            return false;
+        }
+        cout << "Se reanuda desde la operación #" << (uint32_t)start_stage << endl;
+    }
+
+    planes_engine pe = {};
+    if (opts.bit_planes && !planes_engine_init(pe, img_data, img_noisy_data, img_size, mask_size)) {
+        cout << "No se pudo reservar memoria para los planos de bits" << endl;
+        planes_engine_free(pe);
+        delete[] ops;
+        img_free(reversed_mask);
+        img_free(noisy_window);
+        img_free(noisy_chunk);
+        img_free(mask_data);
+        noise_source_close(noise);
+        img_free(img_data);
+        return false;
+    }
+
+    checkpoint_writer cw;
+    cw.snapshot = nullptr;
+    if (checkpoints && !checkpoint_init(cw, img_width, img_height, n, inputs))
+        cout << "No se pudo reservar memoria para los checkpoints, se continúa sin ellos" << endl;
+
+    if (opts.perf) {
+        double resolution_ms = 0;
+        double premain_ms = startup_premain_ms(resolution_ms);
+
+        cout << "Arranque hasta la primera etapa: " << startup_main_ms() << " ms desde main";
+        if (premain_ms >= 0)
+            cout << ", " << premain_ms << " ms antes de main (resolución " << resolution_ms << " ms)";
+        cout << endl;
+    }
+
+    perf_counters pc;
+    bool perf_on = opts.perf && perf_counters_start(pc);
+
+    if (opts.beam_width > 0) {
+        ok_img = beam_search_ops(n, opts.beam_width, img_data, noise, mask_data, reversed_mask,
+                                 img_size, mask_size, ops);
+        //La búsqueda en haz ya revirtió todas las etapas
+        start_stage = 0;
     }
 
     //Se aplicarán las n transformaciones
-    for (int8_t i=n; i > 0; i--) {
-        //Variables para el archivo de enmascaramiento
+    for (int8_t i=start_stage; i > 0; i--) {
+        //Variable para el archivo de enmascaramiento
         uint32_t seed = 0;
-        uint32_t num_pixels = 0;
-        //Se lee el archivo M(n-1).txt
-        QByteArray masked_data_path = "M" + QByteArray::number(i-1) + ".txt";
+        uint32_t num_pixels = mask_width*mask_height;
+        //Se lee el archivo M(n-1).txt y se desenmascara en la misma pasada
+        char masked_data_path[MASK_NAME_SIZE];
+        snprintf(masked_data_path, sizeof(masked_data_path), "M%d.txt", i-1);
 
-        //Se aplica el desenmascaramiento
-        uint8_t *reversed_mask = get_reversed_mask(masked_data_path.data(), mask_data, seed, num_pixels);
-        if (reversed_mask == nullptr) {
+        if (!read_reversed_mask(masked_data_path, mask_data, mask_size, img_size, seed, reversed_mask)) {
             ok_img = false;
             break;
         }
 
-        if ((num_pixels > (img_width*img_height))
-            || num_pixels != (mask_width*mask_height)) {
+        if (opts.bit_planes) {
+            bit_planes_from_bytes(pe.reversed_mask, reversed_mask);
+            bit_planes_window(pe.img, seed, pe.img_window);
+            bit_planes_window(pe.noisy, seed, pe.noisy_window);
+
+            op_n = apply_ops(i, score_planes, &pe, op_code);
+            reverse_operations_planes(pe, op_code, op_n);
+        } else {
+            //Del ruido solo se necesita la ventana que cubre la máscara
+            const uint8_t *noisy = noise_source_window(noise, seed, mask_size, noisy_window);
+            byte_stage stage = {img_data + seed, noisy, reversed_mask, 0, num_pixels};
+
+            op_n = apply_ops(i, score_bytes, &stage, op_code);
+            if ((op_code == XOR_OP) && (img_noisy_data == nullptr))
+                reverse_xor_streamed(img_data, noise, noisy_chunk, chunk_rows*row_size, img_size);
+            else
+                reverse_operations(img_data, img_noisy_data, img_width, img_height, op_code, op_n);
+        }
+        ops[i-1] = {op_code, op_n};
 
-            cout << "La imagen máscara y el archivo de máscara son inconsistentes" << endl;
-            delete[] reversed_mask;
-            ok_img = false;
-            break;
+        //Se guarda el progreso sin detener la reversión
+        if ((cw.snapshot != nullptr) && (((n - i + 1) % CHECKPOINT_INTERVAL) == 0)) {
+            if (opts.bit_planes)
+                bit_planes_to_bytes(pe.img, img_data);
+            checkpoint_save_async(cw, img_data, ops, i-1);
         }
+    }
+
+    if (perf_on)
+        perf_counters_report(pc, "Reversión de la cadena");
+
+    checkpoint_finish(cw);
+
+    if (opts.bit_planes) {
+        bit_planes_to_bytes(pe.img, img_data);
+        planes_engine_free(pe);
+    }
+
+    bool exported = false;
+
+    if (ok_img && low_mem) {
+        //Se escribe directamente desde la imagen, sin la copia que crea QImage
+        exported = bmp_write("I_O.bmp", img_data, img_width, img_height);
+        if (exported)
+            cout << "Imagen BMP modificada guardada como I_O.bmp" << endl;
+        else
+            cout << "Error: No se pudo guardar la imagen BMP modificada.";
+    } else if (ok_img) {
+        exported = exportImage(img_data, img_width, img_height, "I_O.bmp");
+    }
+
+    if (exported) {
+        remove(CHECKPOINT_PATH);
+        //La cadena queda guardada para `reto_1 --verify`
+        if (!chain_save(CHAIN_PATH, ops, n))
+            cout << "No se pudo guardar la cadena en " << CHAIN_PATH << endl;
+    }
+
+    //Los cuadros solo se restauran si la cadena produjo un I_O.bmp válido
+    bool frames_ok = true;
+    if (exported && (opts.frames > 0))
+        frames_ok = process_frames(ops, n, img_noisy_data, img_width, img_height, opts.frames);
+
+    delete[] ops;
+    img_free(reversed_mask);
+    img_free(noisy_window);
+    img_free(noisy_chunk);
+    img_free(mask_data);
+    noise_source_close(noise);
+    img_free(img_data);
+
+    bool budget_ok = true;
+
+    if (low_mem) {
+        uint64_t peak_kib = status_kib("VmHWM:");
+
+        if (peak_kib > 0) {
+            uint64_t above_kib = (peak_kib > baseline_kib) ? peak_kib - baseline_kib : 0;
+            uint64_t budget_kib = (uint64_t)opts.low_mem_budget*1024;
+
+            cout << "Memoria residente máxima: " << peak_kib << " KiB, " << above_kib << " KiB sobre la base de "
+                 << baseline_kib << " KiB (imagen: " << (row_size*img_height) / 1024 << " KiB, ventanas y bloque de I_M: "
+                 << (3*mask_size + (chunk_rows + 1)*row_size) / 1024 << " KiB, presupuesto: " << budget_kib << " KiB)"
+                 << endl;
+
+            if (above_kib > budget_kib) {
+                cout << "Se superó el presupuesto de memoria" << endl;
+                budget_ok = false;
+            }
+        }
+    }
+
+    return exported && frames_ok && budget_ok;
+}
+
+static uint8_t *load_image(const char *path, uint16_t &width, uint16_t &height, const bool low_mem)
+{
+    /**
+     * @brief Carga una imagen BMP como arreglo RGB888 plano.
+     *
+     * En modo de baja memoria las filas se leen con `pread` directamente al arreglo final, sin las copias
+     * transitorias de QImage (imagen original y convertida) ni un mapeo del archivo que sume sus páginas a la memoria
+     * residente. Si `bmp_file_open` no soporta el archivo se usa `loadPixels`.
+     *
+     * @param path Ruta del archivo BMP.
+     * @param width Parámetro de salida con el ancho en píxeles.
+     * @param height Parámetro de salida con el alto en píxeles.
+     * @param low_mem true para evitar las copias intermedias.
+     * @return Arreglo con los píxeles (liberar con `img_free`), o nullptr si no se pudo cargar.
+     */
+    bmp_file bf;
+
+    if (!low_mem || !bmp_file_open(path, bf))
+        return loadPixels(path, width, height);
 
-        op_n = apply_ops(i, img_data, img_noisy_data, reversed_mask, seed, num_pixels, op_code);
-        reverse_operations(img_data, img_noisy_data, img_width, img_height, op_code, op_n);
+    width = bf.width;
+    height = bf.height;
 
-        delete[] reversed_mask;
+    uint32_t size = width*height*RGB_CHANNELS;
+    uint8_t *pixel_data = static_cast<uint8_t *>(img_alloc(size));
+
+    if ((pixel_data != nullptr) && !bmp_file_read_rgb(bf, 0, size, pixel_data)) {
+        cout << "Error: No se pudo leer la imagen BMP " << path << endl;
+        img_free(pixel_data);
+        pixel_data = nullptr;
     }
 
-    if (ok_img)
-        exportImage(img_data, img_width, img_height, "I_O.bmp");
+    bmp_file_close(bf);
+    return pixel_data;
+}
+
+static uint64_t status_kib(const char *field)
+{
+    /**
+     * @brief Lee un campo de memoria de /proc/self/status en KiB: `VmRSS:` (residente actual) o `VmHWM:` (pico).
+     *
+     * Se usa en lugar de `ru_maxrss` de getrusage porque este conserva el pico del proceso padre anterior al
+     * exec (por ejemplo, el de un intérprete que lanza el programa), mientras que VmHWM es solo de esta imagen.
+     *
+     * @param field Nombre del campo, con los dos puntos.
+     * @return Valor del campo en KiB, o 0 si no está disponible.
+     */
+    char line[STATUS_LINE_SIZE];
+    unsigned long long kib = 0;
+    size_t length = strlen(field);
+    FILE *file = fopen("/proc/self/status", "r");
+
+    if (file == nullptr)
+        return 0;
+
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if ((strncmp(line, field, length) == 0) && (sscanf(line + length, "%llu", &kib) == 1))
+            break;
+    }
+    fclose(file);
+
+    return kib;
+}
+
+static void reverse_xor_streamed(uint8_t *img_data, const noise_source &noise, uint8_t *noisy_chunk,
+                                 const uint32_t chunk_size, const uint32_t img_size)
+{
+    /**
+     * @brief Revierte un XOR cuando el ruido no está en memoria, leyéndolo por bloques de `chunk_size` bytes.
+     *
+     * @param img_data Imagen a modificar in-place.
+     * @param noise Fuente de ruido (archivo leído por rangos o generador).
+     * @param noisy_chunk Buffer de `chunk_size` bytes para el ruido.
+     * @param chunk_size Tamaño del bloque de ruido.
+     * @param img_size Número de bytes de la imagen.
+     */
+    fused_chain fc;
 
-    delete[] mask_data;
-    delete[] img_noisy_data;
-    delete[] img_data;
+    fused_chain_init(fc);
+    fused_chain_reverse(fc, XOR_OP, DUMMY_N);
+    noise_source_apply_chain(noise, fc, img_data, img_size, noisy_chunk, chunk_size);
 }
 
 static void reverse_operations(uint8_t *img_data, const uint8_t *img_noisy_data,
@@ -164,9 +550,382 @@ static void reverse_operations(uint8_t *img_data, const uint8_t *img_noisy_data,
     }
 }
 
+static bool beam_search_ops(const uint8_t n, const uint32_t beam_width, uint8_t *img_data, const noise_source &noise,
+                            const uint8_t *mask_data, uint8_t *reversed_mask, const uint32_t img_size,
+                            const uint32_t mask_size, stage_op *ops)
+{
+    /**
+     * @brief Revierte la cadena con búsqueda en haz, conservando las `beam_width` mejores hipótesis en cada etapa.
+     *
+     * La selección voraz de `apply_ops` se queda con el primer candidato de mínima distancia; ante empates o casi
+     * empates (por ejemplo, con ruido) puede tomar un camino equivocado que solo se nota etapas después. Aquí cada
+     * hipótesis es una cadena compilada (`fused_chain`) sobre la imagen base, que no se modifica: evaluar una
+     * hipótesis solo requiere reconstruir la ventana de la máscara con dos consultas de tabla por byte, así que
+     * explorar k caminos cuesta k ventanas por etapa en lugar de k pasadas sobre la imagen completa.
+     *
+     * Los candidatos equivalentes (ROL n y ROR 8-n, desplazamientos o rotaciones de 0 bits, ...) producen la misma
+     * cadena compilada y se cuentan una sola vez (`fused_chain_equal`).
+     *
+     * Un desplazamiento pierde bits: tras revertirlo la ventana tiene ceros que no dicen nada de la imagen, y un
+     * desplazamiento de 8 bits la deja sin información, con lo que las etapas siguientes tendrían distancia cero.
+     * Por eso los desplazamientos se limitan a 7 bits, cada candidato se compara solo en los bits de la ventana que
+     * todavía dependen de `I_D.bmp` (`fused_chain_output_bits`), y cada bit perdido suma 1/`LOST_BIT_WEIGHT` de bit
+     * por byte: menos que un bit que contradice la máscara, pero lo suficiente para que perder bits no salga gratis.
+     * Al final las hipótesis sobrevivientes se reordenan aplicando su cadena en sentido
+     * directo a la imagen restaurada y comparando con `I_D.bmp`; la distancia acumulada solo desempata. La elegida
+     * se aplica a la imagen en una única pasada.
+     *
+     * @param n Número de etapas a revertir.
+     * @param beam_width Número de hipótesis que se conservan por etapa.
+     * @param img_data Imagen transformada; se sobrescribe con el resultado de la mejor hipótesis.
+     * @param noise Fuente de la imagen de ruido; de ella solo se leen las ventanas de las máscaras.
+     * @param mask_data Píxeles de la máscara `M.bmp`.
+     * @param reversed_mask Buffer de `mask_size` bytes donde se desenmascara cada etapa.
+     * @param img_size Número de bytes de la imagen.
+     * @param mask_size Número de bytes de la máscara.
+     * @param ops Arreglo de `n` operaciones donde se guarda la cadena elegida.
+     * @return true si se pudieron revertir todas las etapas; false si algún archivo de enmascaramiento falla.
+     */
+    static const uint8_t op_codes[] = {ROR_OP, ROL_OP, SHL_OP, SHR_OP};
+    uint32_t max_children = beam_width*(1 + sizeof(op_codes)*(BITS_ON_BYTE + 1));
+    beam_hypothesis *beam = new beam_hypothesis[beam_width];
+    beam_hypothesis *children = new beam_hypothesis[max_children];
+    uint32_t *order = new uint32_t[max_children];
+    uint8_t *window = static_cast<uint8_t *>(img_alloc(mask_size));
+    uint8_t *noisy_buffer = static_cast<uint8_t *>(img_alloc(NOISE_CHUNK_SIZE > mask_size ? NOISE_CHUNK_SIZE : mask_size));
+    uint32_t beam_size = 1;
+    bool ok = (window != nullptr) && (noisy_buffer != nullptr);
+
+    fused_chain_init(beam[0].fc);
+    beam[0].score = 0;
+
+    for (int8_t i = n; ok && (i > 0); i--) {
+        uint32_t seed = 0;
+        uint32_t n_children = 0;
+        char masked_data_path[MASK_NAME_SIZE];
+        snprintf(masked_data_path, sizeof(masked_data_path), "M%d.txt", i-1);
+
+        if (!read_reversed_mask(masked_data_path, mask_data, mask_size, img_size, seed, reversed_mask)) {
+            ok = false;
+            break;
+        }
+
+        //Todas las hipótesis comparten la ventana de ruido de la etapa
+        const uint8_t *noisy = noise_source_window(noise, seed, mask_size, noisy_buffer);
+
+        for (uint32_t h = 0; h < beam_size; h++) {
+            //Ventana de la imagen tal como quedaría con las etapas de esta hipótesis ya revertidas
+            memcpy(window, img_data + seed, mask_size);
+            apply_fused_chain(beam[h].fc, window, noisy, mask_size);
+
+            //Bits de la ventana que todavía dependen de I_D.bmp
+            uint8_t known = fused_chain_output_bits(beam[h].fc);
+
+            for (uint8_t c = 0; c < 1 + sizeof(op_codes); c++) {
+                uint8_t op_code = (c == 0) ? XOR_OP : op_codes[c - 1];
+                uint8_t max_n = BITS_ON_BYTE;
+
+                if (op_code == XOR_OP)
+                    max_n = DUMMY_N;
+                else if ((op_code == SHL_OP) || (op_code == SHR_OP))
+                    max_n = BITS_ON_BYTE - 1;
+
+                for (uint8_t op_n = 0; op_n <= max_n; op_n++) {
+                    beam_hypothesis &child = children[n_children];
+                    fused_chain step;
+
+                    fused_chain_init(step);
+                    fused_chain_forward(step, op_code, op_n);
+
+                    child = beam[h];
+                    child.ops[i-1] = {op_code, op_n};
+                    fused_chain_reverse(child.fc, op_code, op_n);
+
+                    uint8_t lost = BITS_ON_BYTE - __builtin_popcount(fused_chain_output_bits(child.fc));
+
+                    child.score += score_window(step, window, noisy, reversed_mask, mask_size, known)
+                                   + (uint64_t)lost*mask_size/LOST_BIT_WEIGHT;
+                    order[n_children] = n_children;
+                    n_children++;
+                }
+            }
+        }
+
+        //Se ordena por distancia acumulada; ante empates se respeta el orden de evaluación de apply_ops
+        stable_sort(order, order + n_children, [children](uint32_t a, uint32_t b) {
+            return children[a].score < children[b].score;
+        });
+
+        beam_size = 0;
+        for (uint32_t c = 0; (c < n_children) && (beam_size < beam_width); c++) {
+            const beam_hypothesis &child = children[order[c]];
+            bool duplicated = false;
+
+            for (uint32_t h = 0; (h < beam_size) && !duplicated; h++)
+                duplicated = fused_chain_equal(beam[h].fc, child.fc);
+
+            if (!duplicated)
+                beam[beam_size++] = child;
+        }
+    }
+
+    if (ok) {
+        //Se reordena por la distancia al volver a aplicar cada cadena; ante empates decide la distancia acumulada
+        uint32_t best_index = 0;
+        uint64_t best_replay = UINT64_MAX;
+
+        for (uint32_t h = 0; h < beam_size; h++) {
+            uint64_t replay = replay_distance(beam[h], n, img_data, noise, img_size, noisy_buffer, best_replay);
+
+            if (replay < best_replay) {
+                best_replay = replay;
+                best_index = h;
+            }
+        }
+
+        const beam_hypothesis &best = beam[best_index];
+
+        for (uint8_t i = n; i > 0; i--) {
+            ops[i-1] = best.ops[i-1];
+            print_stage_op(i, ops[i-1]);
+        }
+        cout << "Distancia de Hamming acumulada de la mejor hipótesis: " << best.score
+             << "; al volver a aplicarla sobre I_D.bmp: " << best_replay << endl;
+
+        noise_source_apply_chain(noise, best.fc, img_data, img_size, noisy_buffer, NOISE_CHUNK_SIZE);
+    }
+
+    img_free(noisy_buffer);
+    img_free(window);
+    delete[] order;
+    delete[] children;
+    delete[] beam;
+
+    return ok;
+}
+
+static uint32_t score_window(const fused_chain &step, const uint8_t *window, const uint8_t *noisy,
+                             const uint8_t *reversed_mask, const uint32_t mask_size, const uint8_t known)
+{
+    /**
+     * @brief Distancia de Hamming entre la ventana y la máscara revertida transformada por un candidato.
+     *
+     * Como `validate_rotate_shift_process` y `validate_xor`, aplica la operación candidata en sentido directo a la
+     * máscara revertida, pero solo cuenta los bits de `known`.
+     *
+     * @param step Cadena compilada (`fused_chain_forward`) con solo la operación candidata.
+     * @param window Ventana de la imagen con las etapas posteriores ya revertidas.
+     * @param noisy Ventana del ruido.
+     * @param reversed_mask Máscara revertida de la etapa.
+     * @param mask_size Número de bytes de la máscara.
+     * @param known Bits de la ventana que dependen de la imagen.
+     * @return Distancia de Hamming en los bits de `known`.
+     */
+    uint32_t total_hamm_dist = 0;
+
+    for (uint32_t k = 0; k < mask_size; k++) {
+        uint8_t expected = step.img_lut[reversed_mask[k]] ^ step.noisy_lut[noisy[k]];
+        total_hamm_dist += hamming_distance(expected & known, window[k] & known);
+    }
+
+    return total_hamm_dist;
+}
+
+static uint64_t replay_distance(const beam_hypothesis &hyp, const uint8_t n, const uint8_t *img_data,
+                                const noise_source &noise, const uint32_t img_size, uint8_t *noisy_chunk,
+                                const uint64_t limit)
+{
+    /**
+     * @brief Distancia de Hamming entre `I_D.bmp` y el resultado de aplicar la cadena de la hipótesis en sentido
+     * directo a la imagen que ella restaura.
+     *
+     * La reversión y la cadena directa se componen en una sola cadena compilada, así que no hace falta materializar
+     * la imagen restaurada: basta una pasada sobre `I_D.bmp` leyendo el ruido por bloques de `NOISE_CHUNK_SIZE`.
+     *
+     * @param hyp Hipótesis a evaluar.
+     * @param n Número de etapas.
+     * @param img_data Imagen `I_D.bmp` sin modificar.
+     * @param noise Fuente de ruido.
+     * @param img_size Número de bytes de la imagen.
+     * @param noisy_chunk Buffer de al menos `NOISE_CHUNK_SIZE` bytes.
+     * @param limit La pasada se corta en cuanto la distancia llega a este valor.
+     * @return Número de bits distintos, o un valor mayor o igual que `limit` si se cortó antes.
+     */
+    fused_chain round_trip = hyp.fc;
+    uint64_t total_hamm_dist = 0;
+
+    for (uint8_t i = 0; i < n; i++)
+        fused_chain_forward(round_trip, hyp.ops[i].op_code, hyp.ops[i].n);
+
+    for (uint32_t offset = 0; (offset < img_size) && (total_hamm_dist < limit); offset += NOISE_CHUNK_SIZE) {
+        uint32_t chunk = (img_size - offset < NOISE_CHUNK_SIZE) ? img_size - offset : NOISE_CHUNK_SIZE;
+        const uint8_t *noisy = round_trip.uses_noise ? noise_source_window(noise, offset, chunk, noisy_chunk) : nullptr;
+
+        for (uint32_t k = 0; k < chunk; k++) {
+            uint8_t replayed = round_trip.img_lut[img_data[offset + k]];
+
+            if (noisy != nullptr)
+                replayed ^= round_trip.noisy_lut[noisy[k]];
+            total_hamm_dist += hamming_distance(replayed, img_data[offset + k]);
+        }
+    }
+
+    return total_hamm_dist;
+}
+
+static void print_stage_op(const uint8_t stage, const stage_op &op)
+{
+    /**
+     * @brief Imprime la operación elegida para una etapa con el mismo formato que `apply_ops`.
+     *
+     * @param stage Número de la etapa.
+     * @param op Operación elegida.
+     */
+    cout << "La operación #" << (uint32_t)stage << " fue: ";
+
+    switch(op.op_code) {
+    case XOR_OP:
+        cout << "XOR" << endl;
+        break;
+    case ROR_OP:
+        cout << "rotación a la derecha de " << (uint32_t)op.n << " bits" << endl;
+        break;
+    case ROL_OP:
+        cout << "rotación a la izquierda de " << (uint32_t)op.n << " bits" << endl;
+        break;
+    case SHL_OP:
+        cout << "desplazamiento a la izquierda de " << (uint32_t)op.n << " bits" << endl;
+        break;
+    case SHR_OP:
+        cout << "desplazamiento a la derecha de " << (uint32_t)op.n << " bits" << endl;
+        break;
+    default:
+        cout << "desconocida" << endl;
+        break;
+    }
+}
+
+static void reverse_operations_planes(planes_engine &pe, const uint8_t op, const uint8_t n)
+{
+    /**
+     * @brief Equivalente de `reverse_operations` sobre la imagen en planos de bits.
+     *
+     * Las rotaciones y desplazamientos inversos solo cambian la correspondencia de planos (costo O(1));
+     * únicamente el XOR recorre los datos.
+     *
+     * @param pe Motor de planos con la imagen a modificar y la imagen de ruido.
+     * @param op Código de la operación original que se desea revertir (XOR, ROR, ROL, SHL, SHR).
+     * @param n Cantidad de bits utilizados originalmente en la operación.
+     */
+
+    switch(op) {
+    case XOR_OP:
+        bit_planes_xor(pe.img, pe.noisy);
+        break;
+    case ROR_OP:
+        bit_planes_rotate_left(pe.img, n);
+        break;
+    case ROL_OP:
+        bit_planes_rotate_right(pe.img, n);
+        break;
+    case SHR_OP:
+        bit_planes_shift_left(pe.img, n);
+        break;
+    case SHL_OP:
+        bit_planes_shift_right(pe.img, n);
+        break;
+    default:
+        cout << "Valor de operación desconocido" << endl;
+    }
+}
+
+static bool planes_engine_init(planes_engine &pe, const uint8_t *img_data, const uint8_t *img_noisy_data,
+                               const uint32_t img_size, const uint32_t mask_size)
+{
+    /**
+     * @brief Reserva los planos de la imagen, del ruido y de las ventanas de comparación.
+     *
+     * La imagen y el ruido se transponen una sola vez; las ventanas tienen el tamaño de la máscara y se
+     * reutilizan en todas las etapas.
+     *
+     * @param pe Motor a inicializar (debe venir en cero para que `planes_engine_free` sea seguro ante fallos).
+     * @param img_data Bytes de la imagen transformada.
+     * @param img_noisy_data Bytes de la imagen de ruido.
+     * @param img_size Número de bytes de la imagen.
+     * @param mask_size Número de bytes de la máscara.
+     * @return true si se reservaron todos los planos; false en caso contrario.
+     */
+    if (!bit_planes_init(pe.img, img_size) || !bit_planes_init(pe.noisy, img_size)
+        || !bit_planes_init(pe.reversed_mask, mask_size) || !bit_planes_init(pe.img_window, mask_size)
+        || !bit_planes_init(pe.noisy_window, mask_size))
+        return false;
 
-static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t *img_noisy, const uint8_t *reversed_mask,
-                                    const uint32_t seed, const uint32_t num_pixels, uint8_t &op_code)
+    bit_planes_from_bytes(pe.img, img_data);
+    bit_planes_from_bytes(pe.noisy, img_noisy_data);
+
+    return true;
+}
+
+static void planes_engine_free(planes_engine &pe)
+{
+    /**
+     * @brief Libera todos los planos del motor.
+     *
+     * @param pe Motor a liberar.
+     */
+    bit_planes_free(pe.img);
+    bit_planes_free(pe.noisy);
+    bit_planes_free(pe.reversed_mask);
+    bit_planes_free(pe.img_window);
+    bit_planes_free(pe.noisy_window);
+}
+
+static uint32_t score_bytes(const void *ctx, const uint8_t op_code, const uint8_t n)
+{
+    /**
+     * @brief Evalúa un candidato sobre la imagen en bytes con `validate_xor` o `validate_rotate_shift_process`.
+     *
+     * @param ctx Puntero a un `byte_stage` con la imagen, el ruido y la máscara de la etapa.
+     * @param op_code Operación candidata.
+     * @param n Número de bits de la operación candidata.
+     * @return Distancia total de Hamming del candidato.
+     */
+    const byte_stage *stage = static_cast<const byte_stage *>(ctx);
+
+    switch(op_code) {
+    case XOR_OP:
+        return validate_xor(stage->img_data, stage->img_noisy, stage->reversed_mask, stage->seed, stage->num_pixels);
+    case ROR_OP:
+        return validate_rotate_shift_process(rotate_right_byte, stage->img_data, stage->reversed_mask, stage->seed, stage->num_pixels, n);
+    case ROL_OP:
+        return validate_rotate_shift_process(rotate_left_byte, stage->img_data, stage->reversed_mask, stage->seed, stage->num_pixels, n);
+    case SHL_OP:
+        return validate_rotate_shift_process(shift_left_byte, stage->img_data, stage->reversed_mask, stage->seed, stage->num_pixels, n);
+    default:
+        return validate_rotate_shift_process(shift_right_byte, stage->img_data, stage->reversed_mask, stage->seed, stage->num_pixels, n);
+    }
+}
+
+static uint32_t score_planes(const void *ctx, const uint8_t op_code, const uint8_t n)
+{
+    /**
+     * @brief Evalúa un candidato sobre las ventanas en planos de bits.
+     *
+     * @param ctx Puntero a un `planes_engine` con las ventanas de la etapa ya extraídas.
+     * @param op_code Operación candidata.
+     * @param n Número de bits de la operación candidata.
+     * @return Distancia total de Hamming del candidato.
+     */
+    const planes_engine *pe = static_cast<const planes_engine *>(ctx);
+
+    if (op_code == XOR_OP)
+        return bit_planes_validate_xor(pe->img_window, pe->noisy_window, pe->reversed_mask);
+
+    return bit_planes_validate_rotate_shift(op_code, pe->img_window, pe->reversed_mask, n);
+}
+
+
+static uint8_t apply_ops(const int8_t op, stage_score score, const void *ctx, uint8_t &op_code)
 {
     /**
      * @brief Determina qué operación bit a bit aplicada a una máscara invertida genera la mayor similitud con una imagen ruidosa.
@@ -174,15 +933,12 @@ static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t
      * Esta función prueba diferentes operaciones bit a bit (XOR, rotaciones y desplazamientos) sobre una máscara invertida
      * para encontrar la que produce mayor similitud con una imagen ruidosa (`img_noisy`) en comparación con la imagen original (`img_data`).
      *
-     * La similitud se calcula usando funciones como `validate_xor` y `validate_ro_sh`, y se mide mediante una métrica como la
-     * distancia de Hamming. Si se encuentra una coincidencia perfecta (`MAX_SIMILARITY`), se retorna inmediatamente.
+     * La similitud de cada candidato se calcula con la función `score` (sobre bytes o sobre planos de bits) y se mide
+     * mediante la distancia de Hamming. Si se encuentra una coincidencia perfecta (`MAX_SIMILARITY`), se retorna inmediatamente.
      *
      * @param op Índice o identificador de la operación que se está evaluando (usado solo para propósitos de impresión).
-     * @param img_data Puntero al arreglo que contiene los datos originales de la imagen limpia.
-     * @param img_noisy Puntero al arreglo con la imagen ruidosa que se quiere comparar.
-     * @param reversed_mask Puntero a la máscara invertida que se usará para probar las operaciones.
-     * @param seed Índice desde el cual se empezará a comparar en la imagen.
-     * @param num_pixels Número de píxeles a evaluar (sin contar canales RGB).
+     * @param score Función que calcula la distancia de Hamming de un candidato en la etapa actual.
+     * @param ctx Datos de la etapa (imagen, ruido, máscara revertida y semilla) que se pasan a `score`.
      * @param op_code Referencia a una variable donde se almacenará el código de la operación con mayor similitud.
      * @return El número de bits usados en la operación que dio mayor similitud (para XOR retorna un valor dummy `DUMMY_N`).
      */
@@ -191,7 +947,7 @@ static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t
     uint8_t op_n = 0;
 
     //Aplicar test para XOR
-    max_op_sim = validate_xor(img_data, img_noisy, reversed_mask, seed, num_pixels);
+    max_op_sim = score(ctx, XOR_OP, DUMMY_N);
 
     if (max_op_sim == MAX_SIMILARITY) {
         cout << "La operación #" << (uint32_t)op << " fue: " << "XOR" << endl;
@@ -200,28 +956,28 @@ static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t
     }
 
     //Aplicar test para ROR
-    op_n = validate_ro_sh(rotate_right_byte, img_data, reversed_mask, seed, num_pixels, op_code, max_op_sim, ROR_OP, op_n);
+    op_n = validate_ro_sh(score, ctx, op_code, max_op_sim, ROR_OP, op_n);
     if (max_op_sim == MAX_SIMILARITY) {
         cout << "La operación #" << (uint32_t)op << " fue: " << "rotación a la derecha de " << (uint32_t)op_n << " bits" << endl;
         return op_n;
     }
 
     //Aplicar test para ROL
-    op_n = validate_ro_sh(rotate_left_byte, img_data, reversed_mask, seed, num_pixels, op_code, max_op_sim, ROL_OP, op_n);
+    op_n = validate_ro_sh(score, ctx, op_code, max_op_sim, ROL_OP, op_n);
     if (max_op_sim == MAX_SIMILARITY) {
         cout << "La operación #" << (uint32_t)op << " fue: " << "rotación a la izquierda de " << (uint32_t)op_n << " bits" << endl;
         return op_n;
     }
 
     //Aplicar test para SHL
-    op_n = validate_ro_sh(shift_left_byte, img_data, reversed_mask, seed, num_pixels, op_code, max_op_sim, SHL_OP, op_n);
+    op_n = validate_ro_sh(score, ctx, op_code, max_op_sim, SHL_OP, op_n);
     if (max_op_sim == MAX_SIMILARITY) {
         cout << "La operación #" << (uint32_t)op << " fue: " << "desplazamiento a la izquierda de " << (uint32_t)op_n << " bits" << endl;
         return op_n;
     }
 
     //Aplicar test para SHR
-    op_n = validate_ro_sh(shift_right_byte, img_data, reversed_mask, seed, num_pixels, op_code, max_op_sim, SHR_OP, op_n);
+    op_n = validate_ro_sh(score, ctx, op_code, max_op_sim, SHR_OP, op_n);
     if (max_op_sim == MAX_SIMILARITY) {
         cout << "La operación #" << (uint32_t)op << " fue: " << "desplazamiento a la derecha de " << (uint32_t)op_n << " bits" << endl;
         return op_n;
@@ -251,26 +1007,20 @@ static uint8_t apply_ops(const int8_t op, const uint8_t *img_data, const uint8_t
     return op_n;
 }
 
-static uint8_t validate_ro_sh(uint8_t (*op)(uint8_t, uint8_t), const uint8_t *img_data,
-                              const uint8_t *reversed_mask, const uint32_t seed, const uint32_t num_pixels,
-                              uint8_t &op_code, uint32_t &max_op_sim, uint8_t curr_op_code, uint8_t curr_n_bits)
+static uint8_t validate_ro_sh(stage_score score, const void *ctx, uint8_t &op_code, uint32_t &max_op_sim,
+                              uint8_t curr_op_code, uint8_t curr_n_bits)
 {
     /**
      * @brief Evalúa múltiples desplazamientos o rotaciones sobre una máscara y determina la mejor configuración.
      *
-     * Esta función aplica una operación bit a bit (`op`) sobre los datos de la máscara invertida (`reversed_mask`)
-     * para cada posible cantidad de bits (de 0 a 8). Luego compara los resultados con los datos originales de imagen
-     * (`img_data`) utilizando la función `validate_rotate_shift_process` y calcula la similitud (por ejemplo, mediante
-     * la distancia de Hamming).
+     * Esta función evalúa con `score` la operación `curr_op_code` sobre la máscara invertida para cada posible
+     * cantidad de bits (de 0 a 8) y calcula la similitud con la imagen (distancia de Hamming).
      *
      * Si una configuración proporciona una mejor similitud (menor distancia), se actualizan los parámetros de salida
      * correspondientes: `max_op_sim`, `op_code` y el número de bits óptimo (`op_n`).
      *
-     * @param op Puntero a una función que realiza una operación bit a bit entre dos valores uint8_t (por ejemplo, rotación o desplazamiento).
-     * @param img_data Puntero al arreglo con los datos de la imagen original.
-     * @param reversed_mask Puntero al arreglo con la máscara invertida que será procesada.
-     * @param seed Índice base en `img_data` desde el cual se iniciará la comparación.
-     * @param num_pixels Número de píxeles (sin contar canales RGB) a procesar.
+     * @param score Función que calcula la distancia de Hamming de un candidato en la etapa actual.
+     * @param ctx Datos de la etapa que se pasan a `score`.
      * @param op_code Referencia a una variable donde se almacenará el código de la operación si se encuentra una mejor.
      * @param max_op_sim Referencia a la variable que contiene la mejor similitud encontrada hasta el momento (valor mínimo).
      * @param curr_op_code Código de la operación actual que se está evaluando.
@@ -281,7 +1031,7 @@ static uint8_t validate_ro_sh(uint8_t (*op)(uint8_t, uint8_t), const uint8_t *im
     uint8_t op_n = curr_n_bits;
 
     for (uint8_t i=0; i <= BITS_ON_BYTE; i++) {
-        uint32_t op_sim = validate_rotate_shift_process(op, img_data, reversed_mask, seed, num_pixels, i);
+        uint32_t op_sim = score(ctx, curr_op_code, i);
         if ((op_sim == MAX_SIMILARITY) || (op_sim < max_op_sim)) {
             max_op_sim = op_sim;
             op_code = curr_op_code;
@@ -291,245 +1041,3 @@ static uint8_t validate_ro_sh(uint8_t (*op)(uint8_t, uint8_t), const uint8_t *im
 
     return op_n;
 }
-
-static uint8_t *get_reversed_mask(const char *path_masking_data, const uint8_t *mask_data, uint32_t &seed, uint32_t &n_pixels)
-{
-    /**
-     * @brief Recupera la máscara original aplicada sobre una imagen usando una semilla y una secuencia de enmascaramiento.
-     *
-     * Esta función carga los datos de enmascaramiento desde un archivo de texto (que contiene la semilla y la secuencia de píxeles a modificar),
-     * y luego utiliza esa información para revertir el proceso de enmascaramiento aplicado sobre una imagen de máscara.
-     *
-     * @param path_masking_data Ruta del archivo que contiene la semilla y los datos de enmascaramiento.
-     * @param mask_data Ruta de la imagen de máscara (formato BMP u otro compatible).
-     * @param seed Referencia a una variable donde se almacenará la semilla leída desde el archivo de enmascaramiento.
-     * @param n_pixels Referencia a una variable donde se almacenará la cantidad de píxeles afectados por la máscara.
-     * @return Puntero a un arreglo de uint8_t que representa la máscara original (recuperada). Debe ser liberado por el llamador con delete[].
-     *         Retorna nullptr si ocurre algún error durante la lectura de archivos o en el proceso de reversión.
-     */
-
-    unsigned int *masking_data = loadSeedMasking(path_masking_data, seed, n_pixels);
-
-    if (masking_data == nullptr) {
-        cout << "Error leyendo el archivo de mascaras" << endl;
-        return nullptr;
-    }
-
-    uint8_t *reversed_mask = reverse_mask(masking_data, mask_data, n_pixels);
-
-    delete[] masking_data;
-
-    if (reversed_mask == nullptr) {
-        cout << "Ocurió un error recuperando la máscara" << endl;
-        return nullptr;
-    }
-
-    return reversed_mask;
-}
-
-static uint8_t *reverse_mask(const uint32_t *bytes_masked, const uint8_t *mask, const uint32_t size)
-{
-    /**
-     * @brief Invierte el enmascaramiento aplicado a una imagen RGB.
-     *
-     * Esta función toma un arreglo de bytes enmascarados (`bytes_masked`) y una máscara (`mask`),
-     * ambos de tamaño `size * RGB_CHANNELS`, y calcula el arreglo original antes del enmascaramiento.
-     * El enmascaramiento asumido es del tipo: s(k) = ID(k+s) + M(k),
-     * por lo que esta función aplica la operación inversa: ID(k+s) = s(k) - M(k)
-     *
-     * @param bytes_masked Puntero a los datos de la imagen enmascarada (RGB intercalado).
-     * @param mask Puntero a los datos de la máscara aplicada (RGB intercalado).
-     * @param size Cantidad de píxeles de la imagen.
-     * @return Puntero a un nuevo arreglo dinámico con los valores desenmascarados.
-     *         Es responsabilidad del llamador liberar esta memoria usando `delete[]`.
-     *
-     * @note El arreglo retornado tiene un tamaño de `size * RGB_CHANNELS` bytes.
-     * @warning Esta función usa memoria dinámica. No olvides liberar el resultado cuando ya no se necesite.
-     */
-    uint8_t *reversed_mask = new uint8_t[size*RGB_CHANNELS];
-
-    if (reversed_mask == nullptr)
-        return nullptr;
-
-    for (uint32_t i = 0; i < size*RGB_CHANNELS; i++)
-        reversed_mask[i] = bytes_masked[i] - mask[i];
-
-    return reversed_mask;
-}
-
-unsigned char* loadPixels(QString input, uint16_t &width, uint16_t &height)
-{
-    /*
-     * @brief Carga una imagen BMP desde un archivo y extrae los datos de píxeles en formato RGB.
-     *
-     * Esta función utiliza la clase QImage de Qt para abrir una imagen en formato BMP, convertirla al
-     * formato RGB888 (24 bits: 8 bits por canal), y copiar sus datos de píxeles a un arreglo dinámico
-     * de tipo unsigned char. El arreglo contendrá los valores de los canales Rojo, Verde y Azul (R, G, B)
-     * de cada píxel de la imagen, sin rellenos (padding).
-     *
-     * @param input Ruta del archivo de imagen BMP a cargar (tipo QString).
-     * @param width Parámetro de salida que contendrá el ancho de la imagen cargada (en píxeles).
-     * @param height Parámetro de salida que contendrá la altura de la imagen cargada (en píxeles).
-     * @return Puntero a un arreglo dinámico que contiene los datos de los píxeles en formato RGB.
-     *         Devuelve nullptr si la imagen no pudo cargarse.
-     *
-     * @note Es responsabilidad del usuario liberar la memoria asignada al arreglo devuelto usando `delete[]`.
-     */
-
-    // Cargar la imagen BMP desde el archivo especificado (usando Qt)
-    QImage imagen(input);
-
-    // Verifica si la imagen fue cargada correctamente
-    if (imagen.isNull()) {
-        cout << "Error: No se pudo cargar la imagen BMP." << std::endl;
-        return nullptr; // Retorna un puntero nulo si la carga falló
-    }
-
-    // Convierte la imagen al formato RGB888 (3 canales de 8 bits sin transparencia)
-    imagen = imagen.convertToFormat(QImage::Format_RGB888);
-
-    // Obtiene el ancho y el alto de la imagen cargada
-    width = imagen.width();
-    height = imagen.height();
-
-    // Calcula el tamaño total de datos (3 bytes por píxel: R, G, B)
-    int dataSize = width * height * 3;
-
-    // Reserva memoria dinámica para almacenar los valores RGB de cada píxel
-    unsigned char* pixelData = new unsigned char[dataSize];
-
-    // Copia cada línea de píxeles de la imagen Qt a nuestro arreglo lineal
-    for (int y = 0; y < height; ++y) {
-        const uchar* srcLine = imagen.scanLine(y);              // Línea original de la imagen con posible padding
-        unsigned char* dstLine = pixelData + y * width * 3;     // Línea destino en el arreglo lineal sin padding
-        memcpy(dstLine, srcLine, width * 3);                    // Copia los píxeles RGB de esa línea (sin padding)
-    }
-
-    // Retorna el puntero al arreglo de datos de píxeles cargado en memoria
-    return pixelData;
-}
-
-bool exportImage(unsigned char* pixelData, uint16_t width, uint16_t height, QString archivoSalida)
-{
-    /*
-     * @brief Exporta una imagen en formato BMP a partir de un arreglo de píxeles en formato RGB.
-     *
-     * Esta función crea una imagen de tipo QImage utilizando los datos contenidos en el arreglo dinámico
-     * `pixelData`, que debe representar una imagen en formato RGB888 (3 bytes por píxel, sin padding).
-     * A continuación, copia los datos línea por línea a la imagen de salida y guarda el archivo resultante
-     * en formato BMP en la ruta especificada.
-     *
-     * @param pixelData Puntero a un arreglo de bytes que contiene los datos RGB de la imagen a exportar.
-     *                  El tamaño debe ser igual a width * height * 3 bytes.
-     * @param width Ancho de la imagen en píxeles.
-     * @param height Alto de la imagen en píxeles.
-     * @param archivoSalida Ruta y nombre del archivo de salida en el que se guardará la imagen BMP (QString).
-     *
-     * @return true si la imagen se guardó exitosamente; false si ocurrió un error durante el proceso.
-     *
-     * @note La función no libera la memoria del arreglo pixelData; esta responsabilidad recae en el usuario.
-     */
-
-    // Crear una nueva imagen de salida con el mismo tamaño que la original
-    // usando el formato RGB888 (3 bytes por píxel, sin canal alfa)
-    QImage outputImage(width, height, QImage::Format_RGB888);
-
-    // Copiar los datos de píxeles desde el buffer al objeto QImage
-    for (int y = 0; y < height; ++y) {
-        // outputImage.scanLine(y) devuelve un puntero a la línea y-ésima de píxeles en la imagen
-        // pixelData + y * width * 3 apunta al inicio de la línea y-ésima en el buffer (sin padding)
-        // width * 3 son los bytes a copiar (3 por píxel)
-        memcpy(outputImage.scanLine(y), pixelData + y * width * 3, width * 3);
-    }
-
-    // Guardar la imagen en disco como archivo BMP
-    if (!outputImage.save(archivoSalida, "BMP")) {
-        // Si hubo un error al guardar, mostrar mensaje de error
-        cout << "Error: No se pudo guardar la imagen BMP modificada.";
-        return false; // Indica que la operación falló
-    } else {
-        // Si la imagen fue guardada correctamente, mostrar mensaje de éxito
-        cout << "Imagen BMP modificada guardada como " << archivoSalida.toStdString() << endl;
-        return true; // Indica éxito
-    }
-
-}
-
-unsigned int* loadSeedMasking(const char* nombreArchivo, uint32_t &seed, uint32_t &n_pixels)
-{
-    /*
-     * @brief Carga la semilla y los resultados del enmascaramiento desde un archivo de texto.
-     *
-     * Esta función abre un archivo de texto que contiene una semilla en la primera línea y,
-     * a continuación, una lista de valores RGB resultantes del proceso de enmascaramiento.
-     * Primero cuenta cuántos tripletes de píxeles hay, luego reserva memoria dinámica
-     * y finalmente carga los valores en un arreglo de enteros.
-     *
-     * @param nombreArchivo Ruta del archivo de texto que contiene la semilla y los valores RGB.
-     * @param seed Variable de referencia donde se almacenará el valor entero de la semilla.
-     * @param n_pixels Variable de referencia donde se almacenará la cantidad de píxeles leídos
-     *                 (equivalente al número de líneas después de la semilla).
-     *
-     * @return Puntero a un arreglo dinámico de enteros que contiene los valores RGB
-     *         en orden secuencial (R, G, B, R, G, B, ...). Devuelve nullptr si ocurre un error al abrir el archivo.
-     *
-     * @note Es responsabilidad del usuario liberar la memoria reservada con delete[].
-     */
-
-    // Abrir el archivo que contiene la semilla y los valores RGB
-    ifstream archivo(nombreArchivo);
-    if (!archivo.is_open()) {
-        // Verificar si el archivo pudo abrirse correctamente
-        cout << "No se pudo abrir el archivo." << endl;
-        return nullptr;
-    }
-
-    // Leer la semilla desde la primera línea del archivo
-    archivo >> seed;
-
-    int r, g, b;
-
-    // Contar cuántos grupos de valores RGB hay en el archivo
-    // Se asume que cada línea después de la semilla tiene tres valores (r, g, b)
-    while (archivo >> r >> g >> b) {
-        n_pixels++;  // Contamos la cantidad de píxeles
-    }
-
-    // Cerrar el archivo para volver a abrirlo desde el inicio
-    archivo.close();
-    archivo.open(nombreArchivo);
-
-    // Verificar que se pudo reabrir el archivo correctamente
-    if (!archivo.is_open()) {
-        cout << "Error al reabrir el archivo." << endl;
-        return nullptr;
-    }
-
-    // Reservar memoria dinámica para guardar todos los valores RGB
-    // Cada píxel tiene 3 componentes: R, G y B
-    unsigned int* RGB = new unsigned int[n_pixels * 3];
-
-    // Leer nuevamente la semilla desde el archivo (se descarta su valor porque ya se cargó antes)
-    archivo >> seed;
-
-    // Leer y almacenar los valores RGB uno por uno en el arreglo dinámico
-    for (uint32_t i = 0; i < n_pixels * 3; i += 3) {
-        archivo >> r >> g >> b;
-        RGB[i] = r;
-        RGB[i + 1] = g;
-        RGB[i + 2] = b;
-    }
-
-    // Cerrar el archivo después de terminar la lectura
-    archivo.close();
-
-    // Mostrar información de control en consola
-    /*
-    cout << "Semilla: " << seed << endl;
-    cout << "Cantidad de píxeles leídos: " << n_pixels << endl;
-    */
-    // Retornar el puntero al arreglo con los datos RGB
-    return RGB;
-}
-
-
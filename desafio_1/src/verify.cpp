@@ -0,0 +1,451 @@
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "include/verify.hpp"
+#include "include/image_io.hpp"
+#include "include/mask_io.hpp"
+#include "include/noise_source.hpp"
+#include "include/img_alloc.hpp"
+#include "include/constants.hpp"
+
+using namespace std;
+
+#define MAX_PIXEL_VALUE 255.0
+
+/// Resultado de la comprobación de una etapa: M<j>.txt contra la imagen reconstruida tras j operaciones
+struct stage_check {
+    bool loaded;            ///< El archivo de enmascaramiento se pudo leer y es consistente
+    image_diff diff;        ///< Diferencias entre la ventana reconstruida y la máscara revertida
+};
+
+static void stage_worker(const fused_chain *prefix, const uint8_t *img_data, const noise_source *noise,
+                         const uint8_t *mask_data, const uint32_t img_size, const uint32_t mask_size,
+                         const uint8_t *kept, const uint32_t first, const uint32_t step, const uint8_t n,
+                         stage_check *checks);
+static void keep_bits(uint8_t *data, const uint32_t size, const uint8_t mask);
+static void print_diff(const char *label, const image_diff &diff, const uint32_t size);
+
+void diff_images(const uint8_t *img_a, const uint8_t *img_b, const uint32_t size, image_diff &diff)
+{
+    /**
+     * @brief Cuenta los bytes y bits distintos y el error cuadrático entre dos arreglos de `size` bytes.
+     *
+     * Los bits distintos se cuentan de a 64 con `popcount` sobre el XOR; un byte es distinto si alguno de sus bits
+     * lo es, lo que se reduce a un bit por byte antes del conteo. Con SSE2 el error cuadrático se acumula de a 16
+     * bytes: las diferencias se extienden a 16 bits y `_mm_madd_epi16` suma sus cuadrados por pares.
+     *
+     * @param img_a Primer arreglo.
+     * @param img_b Segundo arreglo.
+     * @param size Número de bytes a comparar.
+     * @param diff Resultado de la comparación.
+     */
+    const uint64_t low_bits = 0x0101010101010101ULL;
+    uint32_t i = 0;
+
+    diff = {0, 0, 0};
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(img_a + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(img_b + i));
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        __m128i sq = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+        uint32_t lanes[4];
+        uint64_t words[2];
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sq);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(words), _mm_xor_si128(a, b));
+        diff.sq_error += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+        for (uint8_t w = 0; w < 2; w++) {
+            uint64_t x = words[w];
+
+            diff.hamming += __builtin_popcountll(x);
+            x |= x >> 4;
+            x |= x >> 2;
+            x |= x >> 1;
+            diff.bytes_diff += __builtin_popcountll(x & low_bits);
+        }
+    }
+#else
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t a, b;
+
+        memcpy(&a, img_a + i, sizeof(a));
+        memcpy(&b, img_b + i, sizeof(b));
+
+        uint64_t x = a ^ b;
+
+        diff.hamming += __builtin_popcountll(x);
+        x |= x >> 4;
+        x |= x >> 2;
+        x |= x >> 1;
+        diff.bytes_diff += __builtin_popcountll(x & low_bits);
+
+        for (uint8_t k = 0; k < sizeof(uint64_t); k++) {
+            int32_t d = (int32_t)img_a[i + k] - img_b[i + k];
+            diff.sq_error += d*d;
+        }
+    }
+#endif
+
+    for (; i < size; i++) {
+        int32_t d = (int32_t)img_a[i] - img_b[i];
+
+        diff.hamming += hamming_distance(img_a[i], img_b[i]);
+        diff.bytes_diff += (d != 0);
+        diff.sq_error += d*d;
+    }
+}
+
+double diff_psnr(const image_diff &diff, const uint32_t size)
+{
+    /**
+     * @brief Relación señal a ruido pico (en dB) correspondiente a una comparación.
+     *
+     * @return PSNR en decibeles, o infinito si las imágenes son idénticas.
+     */
+    if (diff.sq_error == 0)
+        return INFINITY;
+
+    double mse = (double)diff.sq_error / size;
+    return 10.0 * log10((MAX_PIXEL_VALUE * MAX_PIXEL_VALUE) / mse);
+}
+
+bool chain_save(const char *path, const stage_op *ops, const uint8_t n)
+{
+    /**
+     * @brief Guarda la cadena detectada en un archivo de texto para poder verificarla después.
+     *
+     * El formato es el número de etapas en la primera línea y luego una línea `código bits` por etapa,
+     * de la etapa 1 a la n.
+     *
+     * @param path Ruta del archivo.
+     * @param ops Operaciones detectadas, indexadas por etapa (`ops[i-1]` es la etapa `i`).
+     * @param n Número de etapas.
+     * @return true si el archivo se escribió completo.
+     */
+    FILE *file = fopen(path, "w");
+
+    if (file == nullptr)
+        return false;
+
+    bool ok = fprintf(file, "%u\n", n) > 0;
+
+    for (uint8_t i = 0; ok && (i < n); i++)
+        ok = fprintf(file, "%u %u\n", ops[i].op_code, ops[i].n) > 0;
+
+    return (fclose(file) == 0) && ok;
+}
+
+stage_op *chain_load(const char *path, uint8_t &n)
+{
+    /**
+     * @brief Lee una cadena guardada con `chain_save`.
+     *
+     * @param path Ruta del archivo.
+     * @param n Parámetro de salida con el número de etapas.
+     * @return Arreglo de `n` operaciones (liberar con `delete[]`), o nullptr si el archivo no existe o es inválido.
+     */
+    FILE *file = fopen(path, "r");
+
+    if (file == nullptr) {
+        cout << "No se pudo abrir el archivo " << path << endl;
+        return nullptr;
+    }
+
+    uint32_t count = 0;
+
+    if ((fscanf(file, "%u", &count) != 1) || (count == 0) || (count > INT8_MAX)) {
+        cout << "El archivo " << path << " no contiene una cadena válida" << endl;
+        fclose(file);
+        return nullptr;
+    }
+
+    stage_op *ops = new stage_op[count];
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t op_code, bits;
+
+        if ((fscanf(file, "%u %u", &op_code, &bits) != 2) || (bits > BITS_ON_BYTE)
+            || ((op_code != XOR_OP) && (op_code != ROR_OP) && (op_code != ROL_OP)
+                && (op_code != SHL_OP) && (op_code != SHR_OP))) {
+            cout << "El archivo " << path << " no contiene una cadena válida" << endl;
+            delete[] ops;
+            fclose(file);
+            return nullptr;
+        }
+        ops[i] = {(uint8_t)op_code, (uint8_t)bits};
+    }
+
+    fclose(file);
+    n = count;
+    return ops;
+}
+
+bool verify_chain(const char *reference_path, const bool noise_generated, const uint64_t noise_seed)
+{
+    /**
+     * @brief Verifica `I_O.bmp` volviendo a aplicar la cadena detectada (`cadena.txt`) en sentido directo.
+     *
+     * Las operaciones son lineales sobre los bits del byte, así que la imagen tras las primeras j operaciones se
+     * obtiene de `I_O.bmp` con la cadena compilada del prefijo j (`fused_chain_forward`). Cada `M<j>.txt` solo
+     * necesita la ventana que cubre la máscara, de modo que las n comprobaciones se reparten entre hilos y cada
+     * una toca `M.bmp` bytes en lugar de la imagen completa. Al final se aplica la cadena completa una sola vez y
+     * el resultado se compara byte a byte con `I_D.bmp`. Del ruido solo se leen esas ventanas y, en la pasada
+     * final, bloques consecutivos, así que con el ruido generado no hace falta `I_M.bmp`.
+     *
+     * Si una etapa posterior es un desplazamiento, los bits que este descarta no llegan a `I_D.bmp` y no se pueden
+     * recuperar. Por eso cada `M<j>.txt` se compara solo en los bits que conservan las etapas j+1..n
+     * (`fused_chain_kept_bits` de la cadena del sufijo), tanto en los bytes como en la distancia de Hamming.
+     *
+     * @param reference_path Imagen de referencia opcional con la que se compara `I_O.bmp` en los bits que la cadena
+     * conserva (nullptr para omitirla).
+     * @param noise_generated true si el ruido se genera con Philox4x32-10 en lugar de leer `I_M.bmp`.
+     * @param noise_seed Semilla del generador de ruido.
+     * @return true si todas las etapas y la imagen final coinciden exactamente y, si se dio, `I_O.bmp` es idéntica a
+     * la referencia; false también si la referencia no se puede cargar.
+     */
+    uint8_t n = 0;
+    stage_op *ops = chain_load(CHAIN_PATH, n);
+
+    if (ops == nullptr)
+        return false;
+
+    uint16_t width = 0, height = 0;
+    uint16_t target_width = 0, target_height = 0;
+    uint16_t mask_width = 0, mask_height = 0;
+    uint8_t *img_data = loadPixels("I_O.bmp", width, height);
+    uint8_t *target_data = loadPixels("I_D.bmp", target_width, target_height);
+    uint8_t *mask_data = loadPixels("M.bmp", mask_width, mask_height);
+    uint8_t *reference_data = nullptr;
+    noise_source noise = {};
+    bool ok = (img_data != nullptr) && (target_data != nullptr) && (mask_data != nullptr);
+
+    if (ok && noise_generated)
+        noise_source_generate(noise, noise_seed, width, height);
+    else if (ok)
+        ok = noise_source_open(noise, "I_M.bmp") || noise_source_load(noise, "I_M.bmp");
+
+    if (ok && ((width != noise.width) || (height != noise.height) || (width != target_width) || (height != target_height))) {
+        cout << "I_O.bmp, I_M.bmp e I_D.bmp no tienen las mismas dimensiones" << endl;
+        ok = false;
+    }
+
+    uint32_t img_size = width*height*RGB_CHANNELS;
+    uint32_t mask_size = mask_width*mask_height*RGB_CHANNELS;
+
+    //La referencia se compara aparte: si difiere, las etapas se revisan igual para saber dónde está el error
+    bool reference_match = true;
+
+    if (ok && (reference_path != nullptr)) {
+        uint16_t ref_width = 0, ref_height = 0;
+        reference_data = loadPixels(reference_path, ref_width, ref_height);
+
+        if (reference_data == nullptr) {
+            cout << "No se pudo cargar la imagen de referencia " << reference_path << endl;
+            ok = false;
+        } else if ((ref_width != width) || (ref_height != height)) {
+            cout << "La imagen de referencia no tiene las dimensiones de I_O.bmp" << endl;
+            ok = false;
+        } else {
+            //Los bits que la cadena descarta no se pueden recuperar; no cuentan contra la referencia
+            fused_chain full;
+            uint8_t *kept_img = static_cast<uint8_t *>(img_alloc(img_size));
+
+            fused_chain_init(full);
+            for (uint8_t j = 0; j < n; j++)
+                fused_chain_forward(full, ops[j].op_code, ops[j].n);
+
+            if (kept_img == nullptr) {
+                cout << "No se pudo reservar memoria para comparar con la referencia" << endl;
+                ok = false;
+            } else {
+                image_diff diff;
+
+                memcpy(kept_img, img_data, img_size);
+                keep_bits(kept_img, img_size, fused_chain_kept_bits(full));
+                keep_bits(reference_data, img_size, fused_chain_kept_bits(full));
+                diff_images(kept_img, reference_data, img_size, diff);
+                img_free(kept_img);
+                print_diff("I_O.bmp contra la referencia", diff, img_size);
+                reference_match = (diff.bytes_diff == 0);
+            }
+        }
+    }
+
+    bool all_match = ok;
+
+    if (ok) {
+        //prefix[j] reconstruye la imagen tras las primeras j operaciones
+        fused_chain *prefix = new fused_chain[n + 1];
+        stage_check *checks = new stage_check[n];
+        uint8_t *kept = new uint8_t[n];
+        fused_chain suffix;
+
+        fused_chain_init(prefix[0]);
+        for (uint8_t j = 0; j < n; j++) {
+            prefix[j + 1] = prefix[j];
+            fused_chain_forward(prefix[j + 1], ops[j].op_code, ops[j].n);
+        }
+
+        //kept[j]: bits de la imagen tras j operaciones que sobreviven a las etapas j+1..n
+        for (uint8_t j = 0; j < n; j++) {
+            fused_chain_init(suffix);
+            for (uint8_t k = j; k < n; k++)
+                fused_chain_forward(suffix, ops[k].op_code, ops[k].n);
+            kept[j] = fused_chain_kept_bits(suffix);
+        }
+
+        uint32_t n_threads = thread::hardware_concurrency();
+        if (n_threads == 0)
+            n_threads = 1;
+        if (n_threads > n)
+            n_threads = n;
+
+        thread *workers = new thread[n_threads];
+
+        for (uint32_t t = 0; t < n_threads; t++)
+            workers[t] = thread(stage_worker, prefix, img_data, &noise, mask_data, img_size, mask_size,
+                                kept, t, n_threads, n, checks);
+
+        for (uint32_t t = 0; t < n_threads; t++)
+            workers[t].join();
+
+        delete[] workers;
+
+        for (uint8_t j = 0; j < n; j++) {
+            char label[MASK_NAME_SIZE];
+            if (kept[j] == UINT8_MAX)
+                snprintf(label, sizeof(label), "M%u.txt", j);
+            else
+                snprintf(label, sizeof(label), "M%u.txt (bits 0x%02x)", j, kept[j]);
+
+            if (!checks[j].loaded) {
+                cout << label << ": no se pudo comprobar" << endl;
+                all_match = false;
+                continue;
+            }
+
+            print_diff(label, checks[j].diff, mask_size);
+            all_match = all_match && (checks[j].diff.bytes_diff == 0);
+        }
+
+        //Única pasada sobre la imagen completa
+        image_diff diff;
+        uint8_t *noisy_chunk = static_cast<uint8_t *>(img_alloc(NOISE_CHUNK_SIZE));
+
+        noise_source_apply_chain(noise, prefix[n], img_data, img_size, noisy_chunk, NOISE_CHUNK_SIZE);
+        img_free(noisy_chunk);
+        diff_images(img_data, target_data, img_size, diff);
+        print_diff("Cadena completa contra I_D.bmp", diff, img_size);
+        all_match = all_match && (diff.bytes_diff == 0);
+
+        delete[] kept;
+        delete[] checks;
+        delete[] prefix;
+
+        cout << (all_match ? "La cadena es consistente con todos los archivos de enmascaramiento y con I_D.bmp"
+                           : "La cadena NO es consistente con los datos") << endl;
+
+        if (!reference_match)
+            cout << "I_O.bmp NO coincide con la imagen de referencia" << endl;
+    }
+
+    delete[] ops;
+    img_free(reference_data);
+    img_free(mask_data);
+    img_free(target_data);
+    noise_source_close(noise);
+    img_free(img_data);
+
+    return all_match && reference_match;
+}
+
+static void stage_worker(const fused_chain *prefix, const uint8_t *img_data, const noise_source *noise,
+                         const uint8_t *mask_data, const uint32_t img_size, const uint32_t mask_size,
+                         const uint8_t *kept, const uint32_t first, const uint32_t step, const uint8_t n,
+                         stage_check *checks)
+{
+    /**
+     * @brief Comprueba las etapas `first`, `first + step`, ... contra sus archivos de enmascaramiento.
+     *
+     * @param prefix Cadenas compiladas de cada prefijo (solo lectura).
+     * @param img_data Imagen `I_O.bmp` (solo lectura).
+     * @param noise Fuente de ruido (solo lectura).
+     * @param mask_data Píxeles de la máscara `M.bmp`.
+     * @param img_size Número de bytes de la imagen.
+     * @param mask_size Número de bytes de la máscara.
+     * @param kept Bits comparables de cada etapa; los demás se descartan en ambas ventanas antes de comparar.
+     * @param first Primera etapa asignada a este hilo.
+     * @param step Número total de hilos.
+     * @param n Número de etapas.
+     * @param checks Resultados, uno por etapa; cada hilo escribe solo los suyos.
+     */
+    uint8_t *reversed_mask = static_cast<uint8_t *>(img_alloc(mask_size));
+    uint8_t *window = static_cast<uint8_t *>(img_alloc(mask_size));
+    uint8_t *noisy_window = static_cast<uint8_t *>(img_alloc(mask_size));
+    char path[MASK_NAME_SIZE];
+
+    for (uint32_t j = first; j < n; j += step) {
+        uint32_t seed = 0;
+
+        snprintf(path, sizeof(path), "M%u.txt", j);
+        checks[j].loaded = (reversed_mask != nullptr) && (window != nullptr) && (noisy_window != nullptr)
+                           && read_reversed_mask(path, mask_data, mask_size, img_size, seed, reversed_mask);
+
+        if (!checks[j].loaded)
+            continue;
+
+        memcpy(window, img_data + seed, mask_size);
+        apply_fused_chain(prefix[j], window, noise_source_window(*noise, seed, mask_size, noisy_window), mask_size);
+        keep_bits(window, mask_size, kept[j]);
+        keep_bits(reversed_mask, mask_size, kept[j]);
+        diff_images(window, reversed_mask, mask_size, checks[j].diff);
+    }
+
+    img_free(noisy_window);
+    img_free(window);
+    img_free(reversed_mask);
+}
+
+static void keep_bits(uint8_t *data, const uint32_t size, const uint8_t mask)
+{
+    /**
+     * @brief Pone en cero los bits de cada byte que no están en `mask`.
+     *
+     * @param data Arreglo a modificar.
+     * @param size Número de bytes.
+     * @param mask Bits que se conservan.
+     */
+    if (mask == UINT8_MAX)
+        return;
+
+    for (uint32_t i = 0; i < size; i++)
+        data[i] &= mask;
+}
+
+static void print_diff(const char *label, const image_diff &diff, const uint32_t size)
+{
+    /**
+     * @brief Imprime el resumen de una comparación.
+     */
+    cout << label << ": ";
+
+    if (diff.bytes_diff == 0) {
+        cout << "idéntica" << endl;
+        return;
+    }
+
+    cout << diff.bytes_diff << " de " << size << " bytes distintos, distancia de Hamming " << diff.hamming
+         << ", PSNR " << diff_psnr(diff, size) << " dB" << endl;
+}